@@ -0,0 +1,33 @@
+#include <fcntl.h> /* open, O_RDWR */
+#include <unistd.h> /* close */
+#include <stdio.h> /* printf */
+#include <fscc.h> /* FSCC_* */
+
+int main(void)
+{
+    struct fscc_address_filter filter;
+    int fd = 0;
+
+    fd = open("/dev/fscc0", O_RDWR);
+
+    /* Our station and the broadcast address. */
+    memset(&filter, 0, sizeof(filter));
+
+    filter.width = 1;
+    filter.count = 2;
+    filter.addresses[0] = 0x03;
+    filter.addresses[1] = 0xff;
+
+    ioctl(fd, FSCC_SET_ADDRESS_FILTER, &filter);
+
+    ioctl(fd, FSCC_GET_ADDRESS_FILTER, &filter);
+
+    printf("%u addresses (%s)\n", filter.count,
+           (filter.exact) ? "matched by the card" : "checked by the driver");
+
+    ioctl(fd, FSCC_CLEAR_ADDRESS_FILTER);
+
+    close(fd);
+
+    return 0;
+}
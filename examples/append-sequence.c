@@ -0,0 +1,29 @@
+#include <fcntl.h> /* open, O_RDWR */
+#include <unistd.h> /* close */
+#include <stdio.h> /* printf */
+#include <fscc.h> /* FSCC_* */
+
+int main(void)
+{
+    int fd = 0;
+    unsigned status = 0;
+    struct fscc_rx_drops drops;
+    unsigned i = 0;
+
+    fd = open("/dev/fscc0", O_RDWR);
+
+    ioctl(fd, FSCC_GET_APPEND_SEQUENCE, &status);
+
+    ioctl(fd, FSCC_ENABLE_APPEND_SEQUENCE);
+    ioctl(fd, FSCC_DISABLE_APPEND_SEQUENCE);
+
+    ioctl(fd, FSCC_GET_RX_DROPS, &drops);
+
+    for (i = 0; i < drops.count; i++)
+        printf("lost %u frames from %u (reason %u)\n", drops.ranges[i].count,
+               drops.ranges[i].first, drops.ranges[i].reason);
+
+    close(fd);
+
+    return 0;
+}
@@ -0,0 +1,559 @@
+/*
+    Throughput and latency benchmark for FSCC ports wired in loopback (or an
+    emulated card, see the README). Every frame carries a sequence number and
+    the time it was written, so the receiving side can measure latency and
+    notice lost frames. One result line is printed as CSV.
+
+    gcc -O2 -Wall -I../../lib/raw fscc-bench.c -o fscc-bench -lpthread -lm
+*/
+
+#define _GNU_SOURCE
+
+#include <fcntl.h> /* open, O_RDWR, O_NONBLOCK */
+#include <unistd.h> /* read, write, close */
+#include <stdio.h> /* printf, fprintf, fopen */
+#include <stdlib.h> /* malloc, free, qsort, strtoul */
+#include <string.h> /* memset, memcpy, strcmp */
+#include <stdint.h> /* uint64_t */
+#include <errno.h> /* errno, EAGAIN */
+#include <poll.h> /* poll, POLLIN, POLLOUT */
+#include <pthread.h> /* pthread_* */
+#include <time.h> /* clock_gettime */
+#include <sys/time.h> /* struct timeval */
+#include <sys/resource.h> /* getrusage */
+#include <fscc.h> /* FSCC_* */
+
+#define MAX_PORTS 16
+#define HEADER_SIZE 16 /* Sequence number and send time */
+#define STATUS_SIZE 2
+#define IDLE_TIMEOUT_MS 2000 /* Give up on frames that never arrive */
+
+enum bench_mode { MODE_BLOCKING, MODE_POLL, MODE_BATCH };
+
+static const char *mode_names[] = { "blocking", "poll", "batch" };
+
+struct bench_options {
+    const char *ports[MAX_PORTS];
+    unsigned port_count;
+    unsigned frame_size;
+    unsigned frame_count;
+    unsigned rx_multiple;
+    unsigned append_status;
+    unsigned append_timestamp;
+    unsigned burst;
+    int force_fifo; /* -1 leaves the module setting alone */
+    enum bench_mode mode;
+    unsigned header;
+};
+
+struct bench_port {
+    const struct bench_options *options;
+    const char *name;
+    int fd;
+
+    unsigned record_size; /* A frame as read() returns it */
+    char *tx_buffer;
+    char *rx_buffer;
+    unsigned rx_buffer_size;
+
+    uint64_t *latencies; /* ns, indexed by sequence number */
+    volatile unsigned received;
+    volatile unsigned sent;
+    volatile unsigned writer_done;
+    unsigned errors;
+};
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static void usage(const char *name)
+{
+    fprintf(stderr,
+        "usage: %s [options] [-p /dev/fsccN]...\n"
+        "  -p PORT      port to use, repeat for several ports (default /dev/fscc0)\n"
+        "  -s SIZE      frame size in bytes, at least %u (default 256)\n"
+        "  -n COUNT     frames per port (default 10000)\n"
+        "  -m MODE      blocking, poll or batch (default blocking)\n"
+        "  -b BURST     frames written per wakeup in batch mode (default 16)\n"
+        "  -r           enable rx_multiple\n"
+        "  -a           enable append_status\n"
+        "  -t           enable append_timestamp\n"
+        "  -f           force FIFO mode (writes the force_fifo module option)\n"
+        "  -d           allow DMA (clears the force_fifo module option)\n"
+        "  -H           print the CSV header first\n",
+        name, HEADER_SIZE);
+}
+
+static int parse_options(int argc, char *argv[], struct bench_options *options)
+{
+    int c = 0;
+
+    memset(options, 0, sizeof(*options));
+
+    options->frame_size = 256;
+    options->frame_count = 10000;
+    options->burst = 16;
+    options->force_fifo = -1;
+    options->mode = MODE_BLOCKING;
+
+    while ((c = getopt(argc, argv, "p:s:n:m:b:ratfdH")) != -1) {
+        switch (c) {
+        case 'p':
+            if (options->port_count == MAX_PORTS)
+                return -1;
+
+            options->ports[options->port_count++] = optarg;
+            break;
+
+        case 's':
+            options->frame_size = strtoul(optarg, NULL, 10);
+            break;
+
+        case 'n':
+            options->frame_count = strtoul(optarg, NULL, 10);
+            break;
+
+        case 'm':
+            if (strcmp(optarg, "blocking") == 0)
+                options->mode = MODE_BLOCKING;
+            else if (strcmp(optarg, "poll") == 0)
+                options->mode = MODE_POLL;
+            else if (strcmp(optarg, "batch") == 0)
+                options->mode = MODE_BATCH;
+            else
+                return -1;
+
+            break;
+
+        case 'b':
+            options->burst = strtoul(optarg, NULL, 10);
+            break;
+
+        case 'r':
+            options->rx_multiple = 1;
+            break;
+
+        case 'a':
+            options->append_status = 1;
+            break;
+
+        case 't':
+            options->append_timestamp = 1;
+            break;
+
+        case 'f':
+            options->force_fifo = 1;
+            break;
+
+        case 'd':
+            options->force_fifo = 0;
+            break;
+
+        case 'H':
+            options->header = 1;
+            break;
+
+        default:
+            return -1;
+        }
+    }
+
+    if (options->port_count == 0)
+        options->ports[options->port_count++] = "/dev/fscc0";
+
+    /* Batch mode is built around reading many frames per call. */
+    if (options->mode == MODE_BATCH)
+        options->rx_multiple = 1;
+
+    if (options->frame_size < HEADER_SIZE || options->frame_count == 0 ||
+        options->burst == 0)
+        return -1;
+
+    return 0;
+}
+
+/* force_fifo is checked on every transmit so it can change at run time. */
+static int read_force_fifo(void)
+{
+    FILE *file = fopen("/sys/module/fscc/parameters/force_fifo", "r");
+    int value = -1;
+
+    if (file) {
+        if (fscanf(file, "%d", &value) != 1)
+            value = -1;
+
+        fclose(file);
+    }
+
+    return value;
+}
+
+static int write_force_fifo(int value)
+{
+    FILE *file = fopen("/sys/module/fscc/parameters/force_fifo", "w");
+
+    if (!file)
+        return -1;
+
+    fprintf(file, "%d\n", value);
+    fclose(file);
+
+    return 0;
+}
+
+static int setup_port(struct bench_port *port, const struct bench_options *options)
+{
+    unsigned rx_frames = 1;
+
+    port->options = options;
+    port->fd = open(port->name, O_RDWR);
+
+    if (port->fd == -1) {
+        perror(port->name);
+        return -1;
+    }
+
+    ioctl(port->fd, (options->rx_multiple) ? FSCC_ENABLE_RX_MULTIPLE : FSCC_DISABLE_RX_MULTIPLE);
+    ioctl(port->fd, (options->append_status) ? FSCC_ENABLE_APPEND_STATUS : FSCC_DISABLE_APPEND_STATUS);
+    ioctl(port->fd, (options->append_timestamp) ? FSCC_ENABLE_APPEND_TIMESTAMP : FSCC_DISABLE_APPEND_TIMESTAMP);
+
+    ioctl(port->fd, FSCC_PURGE_TX);
+    ioctl(port->fd, FSCC_PURGE_RX);
+
+    port->record_size = options->frame_size;
+
+    if (options->append_status)
+        port->record_size += STATUS_SIZE;
+
+    if (options->append_timestamp)
+        port->record_size += sizeof(struct timeval); /* Same size as a timespec */
+
+    if (options->rx_multiple)
+        rx_frames = (options->mode == MODE_BATCH) ? 64 : 8;
+
+    port->rx_buffer_size = port->record_size * rx_frames;
+    port->rx_buffer = malloc(port->rx_buffer_size);
+    port->tx_buffer = malloc(options->frame_size);
+    port->latencies = calloc(options->frame_count, sizeof(*port->latencies));
+
+    if (!port->rx_buffer || !port->tx_buffer || !port->latencies)
+        return -1;
+
+    memset(port->tx_buffer, 0x55, options->frame_size);
+
+    return 0;
+}
+
+static void cleanup_port(struct bench_port *port)
+{
+    if (port->fd != -1)
+        close(port->fd);
+
+    free(port->rx_buffer);
+    free(port->tx_buffer);
+    free(port->latencies);
+}
+
+static int send_frame(struct bench_port *port)
+{
+    uint64_t header[2];
+    int result = 0;
+
+    header[0] = port->sent;
+    header[1] = now_ns();
+    memcpy(port->tx_buffer, header, sizeof(header));
+
+    result = write(port->fd, port->tx_buffer, port->options->frame_size);
+
+    if (result > 0)
+        port->sent++;
+
+    return result;
+}
+
+/* Splits what read() returned back into frames and records their latency. */
+static void receive_frames(struct bench_port *port, unsigned length)
+{
+    uint64_t now = now_ns();
+    unsigned offset = 0;
+
+    for (offset = 0; offset + HEADER_SIZE <= length; offset += port->record_size) {
+        uint64_t header[2];
+
+        memcpy(header, port->rx_buffer + offset, sizeof(header));
+
+        if (header[0] < port->options->frame_count && !port->latencies[header[0]]) {
+            port->latencies[header[0]] = now - header[1];
+            port->received++;
+        }
+        else {
+            port->errors++;
+        }
+    }
+}
+
+static void *blocking_writer(void *data)
+{
+    struct bench_port *port = data;
+
+    while (port->sent < port->options->frame_count) {
+        if (send_frame(port) < 0) {
+            port->errors++;
+            break;
+        }
+    }
+
+    port->writer_done = 1;
+
+    return NULL;
+}
+
+static void *blocking_reader(void *data)
+{
+    struct bench_port *port = data;
+    int result = 0;
+
+    pthread_setcanceltype(PTHREAD_CANCEL_ASYNCHRONOUS, NULL);
+
+    while (port->received < port->options->frame_count) {
+        result = read(port->fd, port->rx_buffer, port->rx_buffer_size);
+
+        if (result < 0) {
+            port->errors++;
+            break;
+        }
+
+        receive_frames(port, result);
+    }
+
+    return NULL;
+}
+
+/* Poll and batch modes: one thread per port multiplexing both directions. */
+static void *poll_worker(void *data)
+{
+    struct bench_port *port = data;
+    const struct bench_options *options = port->options;
+    unsigned burst = (options->mode == MODE_BATCH) ? options->burst : 1;
+    uint64_t last_progress = now_ns();
+    struct pollfd fds;
+    int result = 0;
+    unsigned i = 0;
+
+    fcntl(port->fd, F_SETFL, fcntl(port->fd, F_GETFL) | O_NONBLOCK);
+
+    while (port->received < options->frame_count) {
+        fds.fd = port->fd;
+        fds.events = POLLIN;
+
+        if (port->sent < options->frame_count)
+            fds.events |= POLLOUT;
+
+        result = poll(&fds, 1, 100);
+
+        if (result < 0)
+            break;
+
+        if (fds.revents & POLLOUT) {
+            for (i = 0; i < burst && port->sent < options->frame_count; i++) {
+                if (send_frame(port) < 0)
+                    break;
+            }
+        }
+
+        if (fds.revents & POLLIN) {
+            result = read(port->fd, port->rx_buffer, port->rx_buffer_size);
+
+            if (result > 0) {
+                receive_frames(port, result);
+                last_progress = now_ns();
+            }
+        }
+
+        if (now_ns() - last_progress > IDLE_TIMEOUT_MS * 1000000ull)
+            break;
+    }
+
+    port->writer_done = 1;
+
+    return NULL;
+}
+
+static int compare_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+static double percentile(const uint64_t *sorted, unsigned count, double p)
+{
+    unsigned index = 0;
+
+    if (count == 0)
+        return 0;
+
+    index = (unsigned)(p * (count - 1) + 0.5);
+
+    return sorted[index] / 1000.0;
+}
+
+static double cpu_seconds(void)
+{
+    struct rusage usage;
+
+    getrusage(RUSAGE_SELF, &usage);
+
+    return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 +
+           usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+}
+
+int main(int argc, char *argv[])
+{
+    struct bench_options options;
+    struct bench_port ports[MAX_PORTS];
+    pthread_t readers[MAX_PORTS];
+    pthread_t writers[MAX_PORTS];
+    uint64_t *latencies = 0;
+    unsigned latency_count = 0;
+    unsigned frames = 0;
+    unsigned lost = 0;
+    unsigned errors = 0;
+    uint64_t start = 0;
+    uint64_t last_progress = 0;
+    unsigned last_received = 0;
+    double cpu_start = 0;
+    double seconds = 0;
+    double cpu = 0;
+    unsigned i = 0;
+    unsigned j = 0;
+
+    if (parse_options(argc, argv, &options) < 0) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (options.force_fifo != -1 && write_force_fifo(options.force_fifo) < 0) {
+        perror("force_fifo");
+        return EXIT_FAILURE;
+    }
+
+    memset(ports, 0, sizeof(ports));
+
+    for (i = 0; i < options.port_count; i++) {
+        ports[i].fd = -1;
+        ports[i].name = options.ports[i];
+
+        if (setup_port(&ports[i], &options) < 0)
+            return EXIT_FAILURE;
+    }
+
+    cpu_start = cpu_seconds();
+    start = now_ns();
+
+    for (i = 0; i < options.port_count; i++) {
+        if (options.mode == MODE_BLOCKING) {
+            pthread_create(&readers[i], NULL, blocking_reader, &ports[i]);
+            pthread_create(&writers[i], NULL, blocking_writer, &ports[i]);
+        }
+        else {
+            pthread_create(&writers[i], NULL, poll_worker, &ports[i]);
+        }
+    }
+
+    /* Wait for every frame or until nothing has arrived for a while. */
+    last_progress = now_ns();
+
+    for (;;) {
+        unsigned received = 0;
+        unsigned done = 1;
+
+        for (i = 0; i < options.port_count; i++) {
+            received += ports[i].received;
+
+            if (ports[i].received < options.frame_count)
+                done = 0;
+
+            if (options.mode != MODE_BLOCKING && !ports[i].writer_done)
+                done = 0;
+        }
+
+        if (done)
+            break;
+
+        if (received != last_received) {
+            last_received = received;
+            last_progress = now_ns();
+        }
+        else if (now_ns() - last_progress > IDLE_TIMEOUT_MS * 1000000ull) {
+            break;
+        }
+
+        usleep(1000);
+    }
+
+    seconds = (now_ns() - start) / 1e9;
+
+    for (i = 0; i < options.port_count; i++) {
+        if (options.mode == MODE_BLOCKING) {
+            pthread_cancel(readers[i]);
+            pthread_join(readers[i], NULL);
+            ioctl(ports[i].fd, FSCC_PURGE_TX);
+        }
+
+        pthread_join(writers[i], NULL);
+    }
+
+    cpu = cpu_seconds() - cpu_start;
+
+    latencies = malloc(options.port_count * options.frame_count * sizeof(*latencies));
+
+    if (!latencies)
+        return EXIT_FAILURE;
+
+    for (i = 0; i < options.port_count; i++) {
+        frames += ports[i].received;
+        lost += options.frame_count - ports[i].received;
+        errors += ports[i].errors;
+
+        for (j = 0; j < options.frame_count; j++) {
+            if (ports[i].latencies[j])
+                latencies[latency_count++] = ports[i].latencies[j];
+        }
+    }
+
+    qsort(latencies, latency_count, sizeof(*latencies), compare_u64);
+
+    if (options.header) {
+        printf("ports,frame_size,frame_count,mode,rx_multiple,append_status,"
+               "append_timestamp,force_fifo,frames,lost,errors,seconds,"
+               "frames_per_sec,mbit_per_sec,cpu_us_per_frame,p50_us,p99_us,"
+               "p999_us\n");
+    }
+
+    printf("%u,%u,%u,%s,%u,%u,%u,%d,%u,%u,%u,%.6f,%.1f,%.3f,%.3f,%.1f,%.1f,%.1f\n",
+           options.port_count, options.frame_size, options.frame_count,
+           mode_names[options.mode], options.rx_multiple,
+           options.append_status, options.append_timestamp, read_force_fifo(),
+           frames, lost, errors, seconds,
+           frames / seconds,
+           frames * (double)options.frame_size * 8 / seconds / 1e6,
+           (frames) ? cpu * 1e6 / frames : 0,
+           percentile(latencies, latency_count, 0.50),
+           percentile(latencies, latency_count, 0.99),
+           percentile(latencies, latency_count, 0.999));
+
+    free(latencies);
+
+    for (i = 0; i < options.port_count; i++)
+        cleanup_port(&ports[i]);
+
+    return (lost) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
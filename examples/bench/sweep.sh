@@ -0,0 +1,30 @@
+#!/bin/sh
+#
+# Runs fscc-bench across the common parameter combinations and writes one
+# CSV table to stdout. Ports and frame count can be overridden:
+#
+#   PORTS="/dev/fscc0 /dev/fscc1" COUNT=50000 ./sweep.sh > results.csv
+
+BENCH=${BENCH:-./fscc-bench}
+PORTS=${PORTS:-/dev/fscc0}
+COUNT=${COUNT:-10000}
+SIZES=${SIZES:-"16 64 256 1024 4096"}
+
+port_args=""
+for port in $PORTS; do
+    port_args="$port_args -p $port"
+done
+
+header=-H
+
+for transfer in -f -d; do
+    for mode in blocking poll batch; do
+        for size in $SIZES; do
+            for extras in "" "-r" "-a" "-t" "-r -a -t"; do
+                $BENCH $port_args $header $transfer -m $mode -s $size \
+                       -n $COUNT $extras
+                header=
+            done
+        done
+    done
+done
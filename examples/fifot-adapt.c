@@ -0,0 +1,26 @@
+#include <fcntl.h> /* open, O_RDWR */
+#include <unistd.h> /* close */
+#include <string.h> /* memset */
+#include <fscc.h> /* FSCC_*, struct fscc_fifot_adapt */
+
+int main(void)
+{
+    int fd = 0;
+    struct fscc_fifot_adapt adapt;
+
+    fd = open("/dev/fscc0", O_RDWR);
+
+    ioctl(fd, FSCC_GET_FIFOT_ADAPT, &adapt);
+
+    FSCC_FIFOT_ADAPT_INIT(adapt);
+
+    adapt.enabled = 1;
+    adapt.rx_min = 128;
+    adapt.rx_max = 2048;
+
+    ioctl(fd, FSCC_SET_FIFOT_ADAPT, &adapt);
+
+    close(fd);
+
+    return 0;
+}
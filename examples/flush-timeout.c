@@ -0,0 +1,19 @@
+#include <fcntl.h> /* open, O_RDWR */
+#include <unistd.h> /* close */
+#include <fscc.h> /* FSCC_* */
+
+int main(void)
+{
+    int fd = 0;
+    unsigned timeout = 0;
+
+    fd = open("/dev/fscc0", O_RDWR);
+
+    ioctl(fd, FSCC_GET_FLUSH_TIMEOUT, &timeout);
+
+    ioctl(fd, FSCC_SET_FLUSH_TIMEOUT, 100);
+
+    close(fd);
+
+    return 0;
+}
@@ -0,0 +1,19 @@
+#include <fcntl.h> /* open, O_RDWR */
+#include <unistd.h> /* close */
+#include <fscc.h> /* FSCC_* */
+
+int main(void)
+{
+    int fd = 0;
+    unsigned policy = 0;
+
+    fd = open("/dev/fscc0", O_RDWR);
+
+    ioctl(fd, FSCC_GET_INPUT_CAP_POLICY, &policy);
+
+    ioctl(fd, FSCC_SET_INPUT_CAP_POLICY, FSCC_CAP_DROP_OLDEST);
+
+    close(fd);
+
+    return 0;
+}
@@ -0,0 +1,27 @@
+#include <fcntl.h> /* open, O_RDWR */
+#include <unistd.h> /* close */
+#include <errno.h> /* errno, EOVERFLOW */
+#include <stdio.h> /* fprintf */
+#include <fscc.h> /* FSCC_* */
+
+int main(void)
+{
+    int fd = 0;
+    unsigned status = 0;
+    char idata[20];
+
+    fd = open("/dev/fscc0", O_RDWR);
+
+    ioctl(fd, FSCC_GET_REPORT_OVERFLOW, &status);
+
+    ioctl(fd, FSCC_ENABLE_REPORT_OVERFLOW);
+
+    if (read(fd, idata, sizeof(idata)) < 0 && errno == EOVERFLOW)
+        fprintf(stderr, "receive overflow, data was lost\n");
+
+    ioctl(fd, FSCC_DISABLE_REPORT_OVERFLOW);
+
+    close(fd);
+
+    return 0;
+}
@@ -0,0 +1,28 @@
+#include <fcntl.h> /* open, O_RDWR */
+#include <unistd.h> /* close */
+#include <fscc.h> /* FSCC_*, struct sock_fprog */
+
+int main(void)
+{
+    int fd = 0;
+
+    /* Keeps frames sent to address 0x03, truncated to 64 bytes. */
+    struct sock_filter code[] = {
+        BPF_STMT(BPF_LD | BPF_B | BPF_ABS, 0),
+        BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, 0x03, 0, 1),
+        BPF_STMT(BPF_RET | BPF_K, 64),
+        BPF_STMT(BPF_RET | BPF_K, 0),
+    };
+
+    struct sock_fprog program = { sizeof(code) / sizeof(code[0]), code };
+
+    fd = open("/dev/fscc0", O_RDWR);
+
+    ioctl(fd, FSCC_SET_RX_FILTER, &program);
+
+    ioctl(fd, FSCC_CLEAR_RX_FILTER);
+
+    close(fd);
+
+    return 0;
+}
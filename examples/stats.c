@@ -0,0 +1,22 @@
+#include <fcntl.h> /* open, O_RDWR */
+#include <unistd.h> /* close */
+#include <stdio.h> /* fprintf */
+#include <fscc.h> /* FSCC_* */
+
+int main(void)
+{
+    int fd = 0;
+    struct fscc_stats stats;
+
+    fd = open("/dev/fscc0", O_RDWR);
+
+    ioctl(fd, FSCC_GET_STATS, &stats);
+
+    fprintf(stdout, "rx_frames %llu\n", (unsigned long long)stats.rx_frames);
+    fprintf(stdout, "rx_dropped %llu\n", (unsigned long long)stats.rx_dropped);
+    fprintf(stdout, "rdo %llu\n", (unsigned long long)stats.rdo);
+
+    close(fd);
+
+    return 0;
+}
@@ -0,0 +1,19 @@
+#include <fcntl.h> /* open, O_RDWR */
+#include <unistd.h> /* close */
+#include <fscc.h> /* FSCC_* */
+
+int main(void)
+{
+    int fd = 0;
+    unsigned clock = 0;
+
+    fd = open("/dev/fscc0", O_RDWR);
+
+    ioctl(fd, FSCC_GET_TIMESTAMP_CLOCK, &clock);
+
+    ioctl(fd, FSCC_SET_TIMESTAMP_CLOCK, FSCC_TIMESTAMP_MONOTONIC);
+
+    close(fd);
+
+    return 0;
+}
@@ -0,0 +1,40 @@
+#include <fcntl.h> /* open, O_RDWR */
+#include <unistd.h> /* close, write */
+#include <stdio.h> /* printf */
+#include <fscc.h> /* FSCC_* */
+
+int main(void)
+{
+    int fd = 0;
+    unsigned status = 0;
+    uint64_t cookie = 1000;
+    struct fscc_tx_reports reports;
+    char odata[] = "Hello world!";
+    unsigned i = 0;
+
+    fd = open("/dev/fscc0", O_RDWR);
+
+    ioctl(fd, FSCC_GET_TX_REPORTS, &status);
+
+    ioctl(fd, FSCC_ENABLE_TX_REPORTS);
+    ioctl(fd, FSCC_SET_TX_COOKIE, &cookie);
+
+    write(fd, odata, sizeof(odata));
+
+    /* Give the frame time to leave the card */
+    usleep(10000);
+
+    ioctl(fd, FSCC_READ_TX_REPORTS, &reports);
+
+    for (i = 0; i < reports.count; i++)
+        printf("frame %llu %s at %llu ns\n",
+               (unsigned long long)reports.reports[i].cookie,
+               (reports.reports[i].status == FSCC_TX_SENT) ? "sent" : "underran",
+               (unsigned long long)reports.reports[i].timestamp);
+
+    ioctl(fd, FSCC_DISABLE_TX_REPORTS);
+
+    close(fd);
+
+    return 0;
+}
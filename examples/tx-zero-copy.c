@@ -0,0 +1,32 @@
+#include <fcntl.h> /* open, O_RDWR */
+#include <unistd.h> /* write, close */
+#include <stdlib.h> /* malloc, free */
+#include <string.h> /* memset */
+#include <fscc.h> /* FSCC_* */
+
+#define FRAME_SIZE (1024 * 1024)
+
+int main(void)
+{
+    int fd = 0;
+    char *data = 0;
+
+    fd = open("/dev/fscc0", O_RDWR);
+
+    /* Frames of 64 KB and up are sent from user memory. */
+    ioctl(fd, FSCC_SET_TX_ZERO_COPY, 65536);
+
+    data = malloc(FRAME_SIZE);
+    memset(data, 0x7e, FRAME_SIZE);
+
+    /* Returns once the card is done reading data. */
+    write(fd, data, FRAME_SIZE);
+
+    free(data);
+
+    ioctl(fd, FSCC_SET_TX_ZERO_COPY, 0);
+
+    close(fd);
+
+    return 0;
+}
@@ -0,0 +1,25 @@
+#include <fcntl.h> /* open, O_RDWR */
+#include <unistd.h> /* close */
+#include <fscc.h> /* FSCC_*, struct fscc_wakeup */
+
+int main(void)
+{
+    int fd = 0;
+    struct fscc_wakeup wakeup;
+
+    fd = open("/dev/fscc0", O_RDWR);
+
+    ioctl(fd, FSCC_GET_WAKEUP, &wakeup);
+
+    FSCC_WAKEUP_INIT(wakeup);
+
+    wakeup.rx_frames = 16;
+    wakeup.rx_timeout = 10;
+    wakeup.tx_bytes = 4096;
+
+    ioctl(fd, FSCC_SET_WAKEUP, &wakeup);
+
+    close(fd);
+
+    return 0;
+}
@@ -29,12 +29,17 @@ extern "C"
 #include <stdint.h>
 #include <string.h>
 #include <sys/ioctl.h>
+#include <linux/filter.h> /* struct sock_fprog */
 
 #define FSCC_REGISTERS_INIT(regs) memset(&regs, -1, sizeof(regs))
 #define FSCC_MEMORY_CAP_INIT(memcap) memset(&memcap, -1, sizeof(memcap))
+#define FSCC_WAKEUP_INIT(wakeup) memset(&wakeup, -1, sizeof(wakeup))
+#define FSCC_FIFOT_ADAPT_INIT(adapt) memset(&adapt, -1, sizeof(adapt))
 #define FSCC_UPDATE_VALUE -2
 
 enum transmit_type { XF=0, XREP=1, TXT=2, TXEXT=4 };
+enum input_cap_policy { FSCC_CAP_DROP_NEWEST=0, FSCC_CAP_DROP_OLDEST=1, FSCC_CAP_BLOCK=2 };
+enum timestamp_clock { FSCC_TIMESTAMP_LEGACY=0, FSCC_TIMESTAMP_REALTIME=1, FSCC_TIMESTAMP_MONOTONIC=2, FSCC_TIMESTAMP_MONOTONIC_RAW=3, FSCC_TIMESTAMP_TAI=4 };
 
 typedef int64_t fscc_register;
 
@@ -76,6 +81,101 @@ struct fscc_memory_cap {
     int output;
 };
 
+struct fscc_wakeup {
+    int rx_frames; /* Wake readers once this many frames are queued */
+    int rx_bytes; /* ... or once this many bytes are queued */
+    int rx_timeout; /* ... or once data has waited this long (ms) */
+    int tx_bytes; /* Wake writers once this much output room is free */
+};
+
+struct fscc_fifot_adapt {
+    int enabled;
+    int rx_min; /* Bounds for the receive trigger level (bytes) */
+    int rx_max;
+    int tx_min; /* Bounds for the transmit trigger level (bytes) */
+    int tx_max;
+};
+
+/* Reasons an incoming frame never made it to the input queue. */
+#define FSCC_DROP_MEMORY_CAP 0
+#define FSCC_DROP_NO_MEMORY 1
+#define FSCC_DROP_OVERFLOW 2
+#define FSCC_DROP_EVICTED 3
+#define FSCC_DROP_RECLAIMED 4
+#define FSCC_DROP_FILTER 5
+#define FSCC_DROP_ADDRESS 6
+
+#define FSCC_MAX_RX_DROPS 16
+
+struct fscc_rx_drop {
+    uint32_t first; /* Sequence number of the first frame lost */
+    uint32_t count;
+    uint32_t reason; /* FSCC_DROP_* */
+};
+
+struct fscc_rx_drops {
+    unsigned count; /* Ranges filled in, oldest first */
+    unsigned overwritten; /* Older ranges that didn't fit */
+    struct fscc_rx_drop ranges[FSCC_MAX_RX_DROPS];
+};
+
+/* How a frame written with transmit reports enabled left the card. */
+#define FSCC_TX_SENT 0
+#define FSCC_TX_UNDERRUN 1
+
+#define FSCC_MAX_TX_REPORTS 64
+
+struct fscc_tx_report {
+    uint64_t cookie; /* From FSCC_SET_TX_COOKIE, one more for each write */
+    uint64_t timestamp; /* Completion (ns) on the timestamp clock */
+    uint32_t status; /* FSCC_TX_* */
+    uint32_t reserved;
+};
+
+struct fscc_tx_reports {
+    unsigned count; /* Reports filled in, oldest first */
+    unsigned overwritten; /* Older reports that didn't fit */
+    struct fscc_tx_report reports[FSCC_MAX_TX_REPORTS];
+};
+
+#define FSCC_MAX_ADDRESSES 256
+
+struct fscc_address_filter {
+    unsigned width; /* Address length in bytes, 1 or 2 */
+    unsigned count;
+    unsigned exact; /* Read-only, RAR/RAMR match the set by themselves */
+    uint16_t addresses[FSCC_MAX_ADDRESSES];
+};
+
+struct fscc_stats {
+    uint64_t interrupts;
+
+    uint64_t rfs;
+    uint64_t rft;
+    uint64_t rfe;
+    uint64_t rfo;
+    uint64_t rdo;
+    uint64_t rfl;
+    uint64_t tft;
+    uint64_t alls;
+    uint64_t tdu;
+
+    uint64_t rx_frames;
+    uint64_t rx_bytes;
+    uint64_t rx_dropped; /* Frames lost before reaching the input queue */
+    uint64_t rx_memory_cap_rejects;
+    uint64_t rx_cap_dropped_newest;
+    uint64_t rx_cap_dropped_oldest;
+    uint64_t rx_cap_blocked;
+    uint64_t rx_reclaimed; /* Frames dropped under system memory pressure */
+    uint64_t rx_filtered; /* Frames dropped by the receive filter */
+    uint64_t rx_address_rejects; /* Frames dropped by the address filter */
+
+    uint64_t tx_frames;
+    uint64_t tx_bytes;
+    uint64_t tx_memory_cap_rejects;
+};
+
 
 #define FSCC_IOCTL_MAGIC 0x18
 #define FSCC_GET_REGISTERS _IOR(FSCC_IOCTL_MAGIC, 0, struct fscc_registers *)
@@ -108,6 +208,49 @@ struct fscc_memory_cap {
 #define FSCC_DISABLE_APPEND_TIMESTAMP _IO(FSCC_IOCTL_MAGIC, 20)
 #define FSCC_GET_APPEND_TIMESTAMP _IOR(FSCC_IOCTL_MAGIC, 21, unsigned *)
 
+#define FSCC_GET_STATS _IOR(FSCC_IOCTL_MAGIC, 22, struct fscc_stats *)
+
+#define FSCC_ENABLE_REPORT_OVERFLOW _IO(FSCC_IOCTL_MAGIC, 23)
+#define FSCC_DISABLE_REPORT_OVERFLOW _IO(FSCC_IOCTL_MAGIC, 24)
+#define FSCC_GET_REPORT_OVERFLOW _IOR(FSCC_IOCTL_MAGIC, 25, unsigned *)
+
+#define FSCC_SET_INPUT_CAP_POLICY _IOW(FSCC_IOCTL_MAGIC, 26, const unsigned)
+#define FSCC_GET_INPUT_CAP_POLICY _IOR(FSCC_IOCTL_MAGIC, 27, unsigned *)
+
+#define FSCC_SET_WAKEUP _IOW(FSCC_IOCTL_MAGIC, 28, struct fscc_wakeup *)
+#define FSCC_GET_WAKEUP _IOR(FSCC_IOCTL_MAGIC, 29, struct fscc_wakeup *)
+
+#define FSCC_SET_FLUSH_TIMEOUT _IOW(FSCC_IOCTL_MAGIC, 30, const unsigned)
+#define FSCC_GET_FLUSH_TIMEOUT _IOR(FSCC_IOCTL_MAGIC, 31, unsigned *)
+
+#define FSCC_SET_FIFOT_ADAPT _IOW(FSCC_IOCTL_MAGIC, 32, struct fscc_fifot_adapt *)
+#define FSCC_GET_FIFOT_ADAPT _IOR(FSCC_IOCTL_MAGIC, 33, struct fscc_fifot_adapt *)
+
+#define FSCC_SET_TX_ZERO_COPY _IOW(FSCC_IOCTL_MAGIC, 34, const unsigned)
+#define FSCC_GET_TX_ZERO_COPY _IOR(FSCC_IOCTL_MAGIC, 35, unsigned *)
+
+#define FSCC_SET_RX_FILTER _IOW(FSCC_IOCTL_MAGIC, 36, struct sock_fprog *)
+#define FSCC_CLEAR_RX_FILTER _IO(FSCC_IOCTL_MAGIC, 37)
+
+#define FSCC_SET_ADDRESS_FILTER _IOW(FSCC_IOCTL_MAGIC, 38, struct fscc_address_filter *)
+#define FSCC_GET_ADDRESS_FILTER _IOR(FSCC_IOCTL_MAGIC, 39, struct fscc_address_filter *)
+#define FSCC_CLEAR_ADDRESS_FILTER _IO(FSCC_IOCTL_MAGIC, 40)
+
+#define FSCC_ENABLE_APPEND_SEQUENCE _IO(FSCC_IOCTL_MAGIC, 41)
+#define FSCC_DISABLE_APPEND_SEQUENCE _IO(FSCC_IOCTL_MAGIC, 42)
+#define FSCC_GET_APPEND_SEQUENCE _IOR(FSCC_IOCTL_MAGIC, 43, unsigned *)
+
+#define FSCC_GET_RX_DROPS _IOR(FSCC_IOCTL_MAGIC, 44, struct fscc_rx_drops *)
+
+#define FSCC_SET_TIMESTAMP_CLOCK _IOW(FSCC_IOCTL_MAGIC, 45, const unsigned)
+#define FSCC_GET_TIMESTAMP_CLOCK _IOR(FSCC_IOCTL_MAGIC, 46, unsigned *)
+
+#define FSCC_ENABLE_TX_REPORTS _IO(FSCC_IOCTL_MAGIC, 47)
+#define FSCC_DISABLE_TX_REPORTS _IO(FSCC_IOCTL_MAGIC, 48)
+#define FSCC_GET_TX_REPORTS _IOR(FSCC_IOCTL_MAGIC, 49, unsigned *)
+#define FSCC_SET_TX_COOKIE _IOW(FSCC_IOCTL_MAGIC, 50, const uint64_t *)
+#define FSCC_READ_TX_REPORTS _IOR(FSCC_IOCTL_MAGIC, 51, struct fscc_tx_reports *)
+
 
 #ifdef __cplusplus
 }
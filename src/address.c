@@ -0,0 +1,112 @@
+/*
+	Copyright (C) 2014 Commtech, Inc.
+
+	This file is part of fscc-linux.
+
+	fscc-linux is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	fscc-linux is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with fscc-linux.	If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include <linux/slab.h> /* kzalloc */
+#include <linux/bitops.h> /* set_bit, test_bit, hweight32 */
+
+#include "address.h"
+#include "frame.h" /* struct fscc_frame */
+#include "utils.h" /* return_{val_}if_untrue */
+
+/*
+	Receive address filtering. The card compares each frame's address against
+	RAR, ignoring the bits set in RAMR, so it can match any set of addresses
+	that only differ in a fixed group of bits. Larger or irregular sets get
+	the smallest RAR/RAMR pair that covers them and the exact match is done
+	here, with one bit per possible address so a lookup is a single test_bit.
+
+	fscc_port_set_address_filter turns on the card's address mode in CCR0
+	while a set is installed. Every frame is still checked here, the card
+	lets through the whole superset RAR/RAMR describe.
+*/
+
+struct fscc_address_set *fscc_address_set_new(const struct fscc_address_filter *filter,
+											  int *error_code)
+{
+	struct fscc_address_set *set = 0;
+	unsigned address_bits = 0;
+	unsigned distinct = 0;
+	__u32 differing = 0;
+	unsigned i = 0;
+
+	*error_code = -EINVAL;
+
+	return_val_if_untrue(filter->width == 1 || filter->width == 2, 0);
+	return_val_if_untrue(filter->count > 0 &&
+						 filter->count <= FSCC_MAX_ADDRESSES, 0);
+
+	address_bits = filter->width * 8;
+
+	for (i = 0; i < filter->count; i++)
+		return_val_if_untrue(filter->addresses[i] < (1 << address_bits), 0);
+
+	set = kzalloc(sizeof(*set) + BITS_TO_LONGS(1 << address_bits) *
+				  sizeof(unsigned long), GFP_KERNEL);
+
+	if (!set) {
+		*error_code = -ENOMEM;
+		return 0;
+	}
+
+	memcpy(&set->settings, filter, sizeof(set->settings));
+
+	for (i = 0; i < filter->count; i++) {
+		if (!test_and_set_bit(filter->addresses[i], set->bitmap))
+			distinct++;
+
+		differing |= filter->addresses[0] ^ filter->addresses[i];
+	}
+
+	set->ramr = differing;
+	set->rar = filter->addresses[0] & ~differing;
+
+	/* The pair matches exactly the set when it has every combination of
+	   the differing bits. */
+	set->settings.exact = (distinct == (1u << hweight32(differing)));
+
+	*error_code = 0;
+
+	return set;
+}
+
+void fscc_address_set_delete(struct fscc_address_set *set)
+{
+	kfree(set);
+}
+
+/* The address is the first one or two bytes of the frame, first byte high. */
+unsigned fscc_address_set_match(const struct fscc_address_set *set,
+								struct fscc_frame *frame)
+{
+	unsigned char *data = (unsigned char *)frame->buffer;
+	unsigned address = 0;
+
+	return_val_if_untrue(set, 1);
+
+	if (fscc_frame_get_length(frame) < set->settings.width + STATUS_LENGTH)
+		return 0;
+
+	address = data[0];
+
+	if (set->settings.width == 2)
+		address = (address << 8) | data[1];
+
+	return test_bit(address, set->bitmap) ? 1 : 0;
+}
@@ -0,0 +1,41 @@
+/*
+	Copyright (C) 2014 Commtech, Inc.
+
+	This file is part of fscc-linux.
+
+	fscc-linux is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	fscc-linux is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with fscc-linux.	If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef FSCC_ADDRESS_H
+#define FSCC_ADDRESS_H
+
+#include "fscc.h" /* struct fscc_address_filter */
+
+struct fscc_frame;
+
+struct fscc_address_set {
+	struct fscc_address_filter settings;
+	__u32 rar; /* Smallest RAR/RAMR pair that covers every address */
+	__u32 ramr;
+	unsigned long bitmap[0]; /* One bit per possible address */
+};
+
+struct fscc_address_set *fscc_address_set_new(const struct fscc_address_filter *filter,
+											  int *error_code);
+void fscc_address_set_delete(struct fscc_address_set *set);
+unsigned fscc_address_set_match(const struct fscc_address_set *set,
+								struct fscc_frame *frame);
+
+#endif
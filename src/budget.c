@@ -0,0 +1,307 @@
+/*
+	Copyright (C) 2014 Commtech, Inc.
+
+	This file is part of fscc-linux.
+
+	fscc-linux is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	fscc-linux is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with fscc-linux.	If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include <linux/spinlock.h> /* spinlock_t */
+#include <linux/atomic.h> /* atomic_long_t */
+#include <linux/shrinker.h> /* struct shrinker */
+#include <linux/version.h> /* LINUX_VERSION_CODE, KERNEL_VERSION */
+
+#include "budget.h"
+#include "port.h" /* struct fscc_port */
+#include "frame.h" /* FSCC_DROP_RECLAIMED */
+#include "utils.h" /* return_{val_}if_untrue */
+#include "config.h" /* DEVICE_NAME, SYSFS_READ_ONLY_MODE */
+
+extern unsigned memory_budget;
+extern unsigned memory_reserve;
+
+static LIST_HEAD(budget_ports);
+static DEFINE_SPINLOCK(budget_spinlock);
+
+/*
+	Kept up to date by fscc_budget_charge so the hot paths never have to walk
+	the ports. The unused reserves are the sum of memory_reserve minus usage
+	over every port below its reserve.
+*/
+static atomic_long_t budget_usage = ATOMIC_LONG_INIT(0);
+static atomic_long_t budget_unused_reserves = ATOMIC_LONG_INIT(0);
+static atomic_t budget_waiting_ports = ATOMIC_INIT(0);
+
+static long unused_reserve(long usage)
+{
+	return (usage < (long)memory_reserve) ? (long)memory_reserve - usage : 0;
+}
+
+/*
+	A port starts out with all of its reserve unused. Charges before this only
+	move the reserve relative to that, so they still add up correctly.
+*/
+void fscc_budget_add_port(struct fscc_port *port)
+{
+	unsigned long flags = 0;
+
+	return_if_untrue(port);
+
+	atomic_long_add(unused_reserve(0), &budget_unused_reserves);
+
+	spin_lock_irqsave(&budget_spinlock, flags);
+	list_add_tail(&port->budget_list, &budget_ports);
+	spin_unlock_irqrestore(&budget_spinlock, flags);
+}
+
+/* The port's frames are freed after this and bring its usage back to 0. */
+void fscc_budget_remove_port(struct fscc_port *port)
+{
+	unsigned long flags = 0;
+
+	return_if_untrue(port);
+
+	spin_lock_irqsave(&budget_spinlock, flags);
+	list_del(&port->budget_list);
+
+	if (test_and_clear_bit(0, &port->budget_waiting))
+		atomic_dec(&budget_waiting_ports);
+
+	spin_unlock_irqrestore(&budget_spinlock, flags);
+
+	atomic_long_sub(unused_reserve(0), &budget_unused_reserves);
+}
+
+/*
+	Called wherever a port's frame lists change their memory usage. bytes is
+	negative for memory that was given back. Frames that don't belong to a
+	port aren't charged.
+*/
+void fscc_budget_charge(struct fscc_port *port, int bytes)
+{
+	long usage = 0;
+
+	if (!port || bytes == 0)
+		return;
+
+	usage = atomic_add_return(bytes, &port->budget_usage);
+
+	atomic_long_add(bytes, &budget_usage);
+	atomic_long_add(unused_reserve(usage) - unused_reserve(usage - bytes),
+					&budget_unused_reserves);
+}
+
+/*
+	Returns how many more bytes the port may use before going over the driver
+	wide budget. The port's own memory caps still apply on top of this.
+*/
+unsigned fscc_budget_get_room(struct fscc_port *port)
+{
+	long own_usage = 0;
+	long committed = 0;
+	unsigned shared_room = 0;
+	unsigned reserve_room = 0;
+
+	if (memory_budget == 0)
+		return UINT_MAX;
+
+	own_usage = atomic_read(&port->budget_usage);
+	reserve_room = unused_reserve(own_usage);
+
+	/* Other ports keep their unused reserve available to them. */
+	committed = atomic_long_read(&budget_usage) +
+				atomic_long_read(&budget_unused_reserves) - reserve_room;
+
+	if (committed < (long)memory_budget)
+		shared_room = memory_budget - max(committed, 0L);
+
+	return max(shared_room, reserve_room);
+}
+
+unsigned fscc_budget_get_usage(void)
+{
+	return max(atomic_long_read(&budget_usage), 0L);
+}
+
+/* The port was held back by the budget and wants to hear when it frees up. */
+void fscc_budget_wait(struct fscc_port *port)
+{
+	if (!test_and_set_bit(0, &port->budget_waiting))
+		atomic_inc(&budget_waiting_ports);
+}
+
+/*
+	Called after a port frees memory. Ports that stopped receiving or writing
+	because the budget was used up get a chance to continue.
+*/
+void fscc_budget_release(struct fscc_port *port)
+{
+	struct fscc_port *current_port = 0;
+	unsigned long flags = 0;
+
+	if (memory_budget == 0 || atomic_read(&budget_waiting_ports) == 0)
+		return;
+
+	spin_lock_irqsave(&budget_spinlock, flags);
+
+	list_for_each_entry(current_port, &budget_ports, budget_list) {
+		if (!test_and_clear_bit(0, &current_port->budget_waiting))
+			continue;
+
+		atomic_dec(&budget_waiting_ports);
+
+		/* The port freeing the memory wakes its own readers and writers. */
+		if (current_port == port)
+			continue;
+
+		fscc_port_unblock_rx(current_port);
+		wake_up_interruptible(&current_port->output_queue);
+	}
+
+	spin_unlock_irqrestore(&budget_spinlock, flags);
+}
+
+/*
+	Under system memory pressure the oldest received frames are thrown away,
+	one per port at a time so a single port doesn't lose everything. This only
+	happens while the budget is turned on.
+*/
+static unsigned long fscc_budget_count_objects(struct shrinker *shrinker,
+											   struct shrink_control *sc)
+{
+	struct fscc_port *current_port = 0;
+	unsigned long flags = 0;
+	unsigned long count = 0;
+
+	if (memory_budget == 0)
+		return 0;
+
+	spin_lock_irqsave(&budget_spinlock, flags);
+
+	list_for_each_entry(current_port, &budget_ports, budget_list)
+		count += fscc_port_get_input_number_frames(current_port);
+
+	spin_unlock_irqrestore(&budget_spinlock, flags);
+
+	return count;
+}
+
+static unsigned long fscc_budget_scan_objects(struct shrinker *shrinker,
+											  struct shrink_control *sc)
+{
+	struct fscc_port *current_port = 0;
+	unsigned long flags = 0;
+	unsigned long freed = 0;
+	unsigned long last_freed = 0;
+
+	if (memory_budget == 0)
+		return 0;
+
+	spin_lock_irqsave(&budget_spinlock, flags);
+
+	while (freed < sc->nr_to_scan) {
+		last_freed = freed;
+
+		list_for_each_entry(current_port, &budget_ports, budget_list) {
+			if (freed >= sc->nr_to_scan)
+				break;
+
+			if (fscc_port_evict_iframes(current_port, 1, FSCC_DROP_RECLAIMED))
+				freed++;
+		}
+
+		if (freed == last_freed)
+			break;
+	}
+
+	spin_unlock_irqrestore(&budget_spinlock, flags);
+
+	return freed;
+}
+
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(6, 7, 0)
+static struct shrinker *fscc_budget_shrinker;
+#elif LINUX_VERSION_CODE >= KERNEL_VERSION(3, 12, 0)
+static struct shrinker fscc_budget_shrinker = {
+	.count_objects = fscc_budget_count_objects,
+	.scan_objects = fscc_budget_scan_objects,
+	.seeks = DEFAULT_SEEKS,
+};
+#else
+static int fscc_budget_shrink(struct shrinker *shrinker,
+							  struct shrink_control *sc)
+{
+	if (sc->nr_to_scan)
+		fscc_budget_scan_objects(shrinker, sc);
+
+	return fscc_budget_count_objects(shrinker, sc);
+}
+
+static struct shrinker fscc_budget_shrinker = {
+	.shrink = fscc_budget_shrink,
+	.seeks = DEFAULT_SEEKS,
+};
+#endif
+
+void fscc_budget_init(void)
+{
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(6, 7, 0)
+	fscc_budget_shrinker = shrinker_alloc(0, DEVICE_NAME);
+
+	if (!fscc_budget_shrinker) {
+		printk(KERN_WARNING DEVICE_NAME " shrinker_alloc failed\n");
+		return;
+	}
+
+	fscc_budget_shrinker->count_objects = fscc_budget_count_objects;
+	fscc_budget_shrinker->scan_objects = fscc_budget_scan_objects;
+	fscc_budget_shrinker->seeks = DEFAULT_SEEKS;
+
+	shrinker_register(fscc_budget_shrinker);
+#elif LINUX_VERSION_CODE >= KERNEL_VERSION(6, 0, 0)
+	if (register_shrinker(&fscc_budget_shrinker, DEVICE_NAME))
+		printk(KERN_WARNING DEVICE_NAME " register_shrinker failed\n");
+#else
+	if (register_shrinker(&fscc_budget_shrinker))
+		printk(KERN_WARNING DEVICE_NAME " register_shrinker failed\n");
+#endif
+}
+
+void fscc_budget_exit(void)
+{
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(6, 7, 0)
+	shrinker_free(fscc_budget_shrinker);
+#else
+	unregister_shrinker(&fscc_budget_shrinker);
+#endif
+}
+
+static ssize_t memory_usage_show(struct device_driver *driver, char *buf)
+{
+	return sprintf(buf, "%u\n", fscc_budget_get_usage());
+}
+
+static struct driver_attribute driver_attr_memory_usage =
+	__ATTR(memory_usage, SYSFS_READ_ONLY_MODE, memory_usage_show, NULL);
+
+int fscc_budget_sysfs_create(struct device_driver *driver)
+{
+	return driver_create_file(driver, &driver_attr_memory_usage);
+}
+
+void fscc_budget_sysfs_remove(struct device_driver *driver)
+{
+	driver_remove_file(driver, &driver_attr_memory_usage);
+}
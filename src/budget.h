@@ -0,0 +1,51 @@
+/*
+	Copyright (C) 2014 Commtech, Inc.
+
+	This file is part of fscc-linux.
+
+	fscc-linux is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	fscc-linux is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with fscc-linux.	If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef FSCC_BUDGET_H
+#define FSCC_BUDGET_H
+
+#include <linux/list.h> /* struct list_head */
+#include <linux/device.h> /* struct device_driver */
+
+/*
+	The driver wide memory budget is shared by every port. Each port is always
+	allowed to use up to memory_reserve bytes and may borrow whatever the other
+	ports aren't using (minus their reserves) on top of that. A memory_budget
+	of 0 turns the budget off and only the per-port memory caps apply.
+*/
+
+struct fscc_port;
+
+void fscc_budget_init(void);
+void fscc_budget_exit(void);
+
+void fscc_budget_add_port(struct fscc_port *port);
+void fscc_budget_remove_port(struct fscc_port *port);
+
+void fscc_budget_charge(struct fscc_port *port, int bytes);
+unsigned fscc_budget_get_room(struct fscc_port *port);
+unsigned fscc_budget_get_usage(void);
+void fscc_budget_wait(struct fscc_port *port);
+void fscc_budget_release(struct fscc_port *port);
+
+int fscc_budget_sysfs_create(struct device_driver *driver);
+void fscc_budget_sysfs_remove(struct device_driver *driver);
+
+#endif
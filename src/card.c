@@ -19,11 +19,35 @@
 */
 
 #include <linux/version.h>
+#include <linux/dma-mapping.h> /* dma_set_mask, DMA_BIT_MASK */
 #include <asm/byteorder.h> /* __BIG_ENDIAN */
 #include "card.h"
 #include "port.h" /* struct fscc_port */
 #include "utils.h" /* return_{val_}if_true */
+#include "config.h" /* SYSFS_READ_ONLY_MODE */
 
+#ifdef FSCC_EMULATED
+#include "emulated.h" /* fscc_emulated_* */
+#endif
+
+static ssize_t memory_usage_show(struct device *dev,
+								 struct device_attribute *attr, char *buf)
+{
+	struct fscc_card *card = 0;
+	unsigned usage = 0;
+
+	/* Emulated cards have no pci_dev so match on the device itself. */
+	list_for_each_entry(card, &fscc_cards, list) {
+		if (fscc_card_get_device(card) == dev) {
+			usage = fscc_card_get_memory_usage(card);
+			break;
+		}
+	}
+
+	return sprintf(buf, "%u\n", usage);
+}
+
+static DEVICE_ATTR(memory_usage, SYSFS_READ_ONLY_MODE, memory_usage_show, NULL);
 
 /*
 	This handles initialization on a card (2 port) level. So anything that
@@ -36,8 +60,6 @@ struct fscc_card *fscc_card_new(struct pci_dev *pdev,
 								struct file_operations *fops)
 {
 	struct fscc_card *card = 0;
-	struct fscc_port *port_iter = 0;
-	static unsigned minor_number = 0;
 	unsigned i = 0;
 
 	card = kmalloc(sizeof(*card), GFP_KERNEL);
@@ -49,6 +71,7 @@ struct fscc_card *fscc_card_new(struct pci_dev *pdev,
 
 	card->pci_dev = pdev;
 	card->dma = 0;
+	card->emulated = 0;
 
 	switch (pdev->device) {
 	case SFSCC_ID:
@@ -63,7 +86,7 @@ struct fscc_card *fscc_card_new(struct pci_dev *pdev,
 	case SFSCC_UA_LVDS_ID:
 	case SFSCC_4_UA_LVDS_ID:
 	case SFSCCe_4_LVDS_UA_ID:
-		if (pci_set_dma_mask(pdev, 0xffffffff)) {
+		if (dma_set_mask(&pdev->dev, DMA_BIT_MASK(32))) {
 			dev_warn(&card->pci_dev->dev, "no suitable DMA available\n");
 		}
 		else {
@@ -85,7 +108,7 @@ struct fscc_card *fscc_card_new(struct pci_dev *pdev,
 		return 0;
 	}
 
-	if (pci_set_dma_mask(pdev, 0xffffffff)) {
+	if (dma_set_mask(&pdev->dev, DMA_BIT_MASK(32))) {
 		dev_warn(&card->pci_dev->dev, "no suitable DMA available\n");
 		return 0;
 	}
@@ -100,10 +123,24 @@ struct fscc_card *fscc_card_new(struct pci_dev *pdev,
 		}
 	}
 
+	fscc_card_create_ports(card, major_number, class, fops);
+
+	return card;
+}
+
+/* Shared by PCI and emulated cards so minor numbers stay unique. */
+void fscc_card_create_ports(struct fscc_card *card, unsigned major_number,
+							struct class *class,
+							struct file_operations *fops)
+{
+	struct fscc_port *port_iter = 0;
+	static unsigned minor_number = 0;
+	unsigned i = 0;
+
 	/* There are two ports per card. */
 	for (i = 0; i < 2; i++) {
 		port_iter = fscc_port_new(card, i, major_number, minor_number,
-								  &card->pci_dev->dev, class, fops);
+								  fscc_card_get_device(card), class, fops);
 
 		if (port_iter)
 			list_add_tail(&port_iter->list, &card->ports);
@@ -111,7 +148,8 @@ struct fscc_card *fscc_card_new(struct pci_dev *pdev,
 		minor_number += 1;
 	}
 
-	return card;
+	if (device_create_file(fscc_card_get_device(card), &dev_attr_memory_usage) < 0)
+		dev_warn(fscc_card_get_device(card), "memory_usage attribute failed\n");
 }
 
 void fscc_card_delete(struct fscc_card *card)
@@ -121,6 +159,14 @@ void fscc_card_delete(struct fscc_card *card)
 
 	return_if_untrue(card);
 
+	device_remove_file(fscc_card_get_device(card), &dev_attr_memory_usage);
+
+#ifdef FSCC_EMULATED
+	/* Keeps the model from raising interrupts on ports being deleted. */
+	if (card->emulated)
+		fscc_emulated_stop(card->emulated);
+#endif
+
 	list_for_each_safe(current_node, temp_node, &card->ports) {
 		struct fscc_port *current_port = 0;
 
@@ -130,6 +176,14 @@ void fscc_card_delete(struct fscc_card *card)
 		fscc_port_delete(current_port);
 	}
 
+#ifdef FSCC_EMULATED
+	if (card->emulated) {
+		fscc_emulated_delete(card->emulated);
+		kfree(card);
+		return;
+	}
+#endif
+
 	pci_release_region(card->pci_dev, 0);
 	pci_release_region(card->pci_dev, 2);
 
@@ -198,6 +252,11 @@ __u32 fscc_card_get_register(struct fscc_card *card, unsigned bar,
 	return_val_if_untrue(card, 0);
 	return_val_if_untrue(bar <= 2, 0);
 
+#ifdef FSCC_EMULATED
+	if (card->emulated)
+		return fscc_emulated_get_register(card->emulated, bar, offset);
+#endif
+
 	address = fscc_card_get_BAR(card, bar);
 
 	value = ioread32(address + offset);
@@ -219,6 +278,13 @@ void fscc_card_set_register(struct fscc_card *card, unsigned bar,
 	return_if_untrue(card);
 	return_if_untrue(bar <= 2);
 
+#ifdef FSCC_EMULATED
+	if (card->emulated) {
+		fscc_emulated_set_register(card->emulated, bar, offset, value);
+		return;
+	}
+#endif
+
 	address = fscc_card_get_BAR(card, bar);
 
 	value = cpu_to_le32(value);
@@ -245,6 +311,14 @@ void fscc_card_get_register_rep(struct fscc_card *card, unsigned bar,
 	return_if_untrue(buf);
 	return_if_untrue(byte_count > 0);
 
+#ifdef FSCC_EMULATED
+	if (card->emulated) {
+		fscc_emulated_get_register_rep(card->emulated, bar, offset, buf,
+									   byte_count);
+		return;
+	}
+#endif
+
 	address = fscc_card_get_BAR(card, bar);
 	leftover_count = byte_count % 4;
 	chunks = (byte_count - leftover_count) / 4;
@@ -295,6 +369,14 @@ void fscc_card_set_register_rep(struct fscc_card *card, unsigned bar,
 	return_if_untrue(data);
 	return_if_untrue(byte_count > 0);
 
+#ifdef FSCC_EMULATED
+	if (card->emulated) {
+		fscc_emulated_set_register_rep(card->emulated, bar, offset, data,
+									   byte_count);
+		return;
+	}
+#endif
+
 	address = fscc_card_get_BAR(card, bar);
 	leftover_count = byte_count % 4;
 	chunks = (byte_count - leftover_count) / 4;
@@ -330,10 +412,29 @@ struct list_head *fscc_card_get_ports(struct fscc_card *card)
 	return &card->ports;
 }
 
+/* Memory held by all of the card's ports, in both directions. */
+unsigned fscc_card_get_memory_usage(struct fscc_card *card)
+{
+	struct fscc_port *current_port = 0;
+	unsigned usage = 0;
+
+	return_val_if_untrue(card, 0);
+
+	list_for_each_entry(current_port, &card->ports, list) {
+		usage += fscc_port_get_input_memory_usage(current_port);
+		usage += fscc_port_get_output_memory_usage(current_port);
+	}
+
+	return usage;
+}
+
 unsigned fscc_card_get_irq(struct fscc_card *card)
 {
 	return_val_if_untrue(card, 0);
 
+	if (card->emulated)
+		return 0;
+
 	return card->pci_dev->irq;
 }
 
@@ -341,11 +442,26 @@ struct device *fscc_card_get_device(struct fscc_card *card)
 {
 	return_val_if_untrue(card, 0);
 
+#ifdef FSCC_EMULATED
+	if (card->emulated)
+		return fscc_emulated_get_device(card->emulated);
+#endif
+
 	return &card->pci_dev->dev;
 }
 
+unsigned fscc_card_is_emulated(struct fscc_card *card)
+{
+	return_val_if_untrue(card, 0);
+
+	return (card->emulated) ? 1 : 0;
+}
+
 char *fscc_card_get_name(struct fscc_card *card)
 {
+	if (card->emulated)
+		return (card->dma) ? "SuperFSCC Emulated" : "FSCC Emulated";
+
 	switch (card->pci_dev->device) {
 	case FSCC_ID:
 	case FSCC_UA_ID:
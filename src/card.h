@@ -28,6 +28,8 @@
 #define FCR_OFFSET 0x00
 #define DSTAR_OFFSET 0x30
 
+struct fscc_emulated;
+
 struct fscc_card {
 	struct list_head list;
 	struct list_head ports;
@@ -36,6 +38,8 @@ struct fscc_card {
 	void __iomem *bar[3];
 
 	unsigned dma;
+
+	struct fscc_emulated *emulated; /* Software model instead of a PCI device */
 };
 
 struct fscc_card *fscc_card_new(struct pci_dev *pdev,
@@ -43,6 +47,9 @@ struct fscc_card *fscc_card_new(struct pci_dev *pdev,
 								struct class *class,
 								struct file_operations *fops);
 
+void fscc_card_create_ports(struct fscc_card *card, unsigned major_number,
+							struct class *class,
+							struct file_operations *fops);
 void fscc_card_delete(struct fscc_card *card);
 void fscc_card_suspend(struct fscc_card *card);
 void fscc_card_resume(struct fscc_card *card);
@@ -68,7 +75,9 @@ void fscc_card_set_register_rep(struct fscc_card *card, unsigned bar,
 
 struct list_head *fscc_card_get_ports(struct fscc_card *card);
 unsigned fscc_card_get_irq(struct fscc_card *card);
+unsigned fscc_card_get_memory_usage(struct fscc_card *card);
 struct device *fscc_card_get_device(struct fscc_card *card);
 char *fscc_card_get_name(struct fscc_card *card);
+unsigned fscc_card_is_emulated(struct fscc_card *card);
 
 #endif
@@ -26,15 +26,35 @@
 #define DEFAULT_INPUT_MEMORY_CAP_VALUE 1000000
 #define DEFAULT_OUTPUT_MEMORY_CAP_VALUE 1000000
 
+#define DEFAULT_MEMORY_BUDGET_VALUE 0
+#define DEFAULT_MEMORY_RESERVE_VALUE 65536
+
 #define DEFAULT_TIMEOUT_VALUE 50
+#define DEFAULT_FLUSH_TIMEOUT_VALUE 1000 /* Microseconds */
+#define FSCC_MIN_FLUSH_TIMEOUT 10
 #define DEFAULT_FORCE_FIFO_VALUE 0
 #define DEFAULT_APPEND_STATUS_VALUE 0
 #define DEFAULT_APPEND_TIMESTAMP_VALUE 0
+#define DEFAULT_APPEND_SEQUENCE_VALUE 0
 #define DEFAULT_IGNORE_TIMEOUT_VALUE 0
 #define DEFAULT_TX_MODIFIERS_VALUE XF
 #define DEFAULT_RX_MULTIPLE_VALUE 0
+#define DEFAULT_REPORT_OVERFLOW_VALUE 0
+#define DEFAULT_INPUT_CAP_POLICY_VALUE FSCC_CAP_DROP_NEWEST
+#define DEFAULT_TIMESTAMP_CLOCK_VALUE FSCC_TIMESTAMP_LEGACY
+#define DEFAULT_RX_WAKE_FRAMES_VALUE 1
+#define DEFAULT_RX_WAKE_BYTES_VALUE 0
+#define DEFAULT_RX_WAKE_TIMEOUT_VALUE 0
+#define DEFAULT_TX_WAKE_BYTES_VALUE 0
+#define DEFAULT_TX_ZERO_COPY_VALUE 0
+#define DEFAULT_TX_REPORTS_VALUE 0
 
 #define DEFAULT_FIFOT_VALUE 0x08001000
+#define DEFAULT_FIFOT_ADAPT_VALUE 0
+#define DEFAULT_FIFOT_RX_MIN_VALUE 64
+#define DEFAULT_FIFOT_RX_MAX_VALUE 8000
+#define DEFAULT_FIFOT_TX_MIN_VALUE 64
+#define DEFAULT_FIFOT_TX_MAX_VALUE 4000
 #define DEFAULT_CCR0_VALUE 0x0011201c
 #define DEFAULT_CCR1_VALUE 0x00000018
 #define DEFAULT_CCR2_VALUE 0x00000000
@@ -0,0 +1,795 @@
+/*
+	Copyright (C) 2014 Commtech, Inc.
+
+	This file is part of fscc-linux.
+
+	fscc-linux is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	fscc-linux is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with fscc-linux.	If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include <linux/version.h> /* LINUX_VERSION_CODE, KERNEL_VERSION */
+#include <linux/module.h> /* module_param */
+#include <linux/slab.h> /* kmalloc */
+#include <linux/hrtimer.h> /* struct hrtimer */
+#include <linux/math64.h> /* div_u64_rem */
+#include <linux/dma-mapping.h> /* DMA_BIT_MASK */
+#include <asm/io.h> /* phys_to_virt, virt_to_phys */
+
+#include "emulated.h"
+#include "card.h" /* struct fscc_card */
+#include "port.h" /* struct fscc_port, *_OFFSET */
+#include "frame.h" /* DESC_*_BIT */
+#include "isr.h" /* fscc_isr */
+#include "utils.h" /* return_{val_}if_untrue */
+#include "config.h" /* DEVICE_NAME */
+
+/*
+	A software model of an FSCC card for testing and benchmarking without the
+	hardware. Register accesses that would go to the card's BARs land here
+	instead. Each port is looped back onto itself: whatever is transmitted,
+	from the FIFO or by walking the DMA descriptors, shows up in the same
+	port's receive FIFO at emulated_line_rate bytes per second. Interrupts
+	are raised by calling fscc_isr from the line timer.
+
+	The model covers what the driver relies on (FIFOs, byte and frame
+	counts, FIFOT, ISR/IMR, the transmit descriptor walk), not the line
+	protocol. Descriptor addresses are turned back into pointers with
+	phys_to_virt, so this assumes DMA addresses are physical addresses (no
+	IOMMU).
+*/
+
+static unsigned emulated_cards = 1;
+static unsigned emulated_dma = 1;
+static unsigned emulated_line_rate = 1250000; /* Bytes per second */
+
+/* Status bytes the model appends to every frame, all error bits clear. */
+#define EMULATED_RX_STATUS 0x0000
+
+struct fscc_emulated_fifo {
+	char *data;
+	unsigned size;
+	unsigned head;
+	unsigned count;
+};
+
+struct fscc_emulated_counts {
+	unsigned values[EMULATED_MAX_FRAMES];
+	unsigned head;
+	unsigned count;
+};
+
+struct fscc_emulated_channel {
+	__u32 registers[0x80 / 4];
+	__u32 isr; /* Latched until ISR is read */
+
+	struct fscc_emulated_fifo rx;
+	struct fscc_emulated_fifo tx;
+	char rx_data[EMULATED_RX_FIFO_SIZE];
+	char tx_data[EMULATED_TX_FIFO_SIZE];
+
+	struct fscc_emulated_counts rx_counts; /* Frames waiting in the rx FIFO */
+	struct fscc_emulated_counts tx_counts; /* BC_FIFO_L values written */
+
+	unsigned tx_sent; /* Bytes of the current FIFO frame already sent */
+	unsigned tx_active; /* ALLS is due once the transmitter goes idle */
+	unsigned rx_length; /* Bytes of the frame currently arriving */
+
+	__u32 dmaccr;
+	__u32 dma_rx_base;
+	__u32 dma_tx_base;
+	struct fscc_descriptor *dma_descriptor; /* Being sent, 0 when idle */
+	unsigned dma_offset;
+};
+
+struct fscc_emulated {
+	struct fscc_card *card;
+	struct device *device;
+
+	spinlock_t lock;
+	struct hrtimer line_timer;
+	unsigned line_running;
+	unsigned stopped;
+	__u64 line_time; /* Last tick (ns) */
+	__u32 line_remainder;
+
+	__u32 fcr;
+	struct fscc_emulated_channel channels[2];
+};
+
+static unsigned fifo_push(struct fscc_emulated_fifo *fifo, const char *data,
+						  unsigned length)
+{
+	unsigned i = 0;
+
+	for (i = 0; i < length && fifo->count < fifo->size; i++) {
+		fifo->data[(fifo->head + fifo->count) % fifo->size] = data[i];
+		fifo->count++;
+	}
+
+	return i;
+}
+
+static unsigned fifo_pop(struct fscc_emulated_fifo *fifo, char *data,
+						 unsigned length)
+{
+	unsigned i = 0;
+
+	for (i = 0; i < length && fifo->count; i++) {
+		if (data)
+			data[i] = fifo->data[fifo->head];
+
+		fifo->head = (fifo->head + 1) % fifo->size;
+		fifo->count--;
+	}
+
+	return i;
+}
+
+static void fifo_clear(struct fscc_emulated_fifo *fifo)
+{
+	fifo->head = 0;
+	fifo->count = 0;
+}
+
+static unsigned counts_push(struct fscc_emulated_counts *counts, unsigned value)
+{
+	if (counts->count == EMULATED_MAX_FRAMES)
+		return 0;
+
+	counts->values[(counts->head + counts->count) % EMULATED_MAX_FRAMES] = value;
+	counts->count++;
+
+	return 1;
+}
+
+static unsigned counts_peek(struct fscc_emulated_counts *counts)
+{
+	if (counts->count == 0)
+		return 0;
+
+	return counts->values[counts->head];
+}
+
+static unsigned counts_pop(struct fscc_emulated_counts *counts)
+{
+	unsigned value = counts_peek(counts);
+
+	if (counts->count) {
+		counts->head = (counts->head + 1) % EMULATED_MAX_FRAMES;
+		counts->count--;
+	}
+
+	return value;
+}
+
+static void counts_clear(struct fscc_emulated_counts *counts)
+{
+	counts->head = 0;
+	counts->count = 0;
+}
+
+/* Same rule as fscc_port_is_streaming, but on the model's registers. */
+static unsigned channel_is_streaming(struct fscc_emulated_channel *channel)
+{
+	__u32 ccr0 = channel->registers[CCR0_OFFSET / 4];
+	__u32 ccr2 = channel->registers[CCR2_OFFSET / 4];
+	unsigned transparent_or_xsync = ((ccr0 & 0x3) == 0x2 || (ccr0 & 0x3) == 0x1);
+
+	return transparent_or_xsync && !(ccr2 & 0xffff0000) && !(ccr0 & 0x700) &&
+		   !(ccr0 & 0x70000);
+}
+
+static unsigned channel_tx_idle(struct fscc_emulated_channel *channel)
+{
+	return !channel->dma_descriptor && channel->tx_counts.count == 0;
+}
+
+/* The null descriptor (all zero) ends a chain just like a null address. */
+static struct fscc_descriptor *descriptor_at(__u32 handle)
+{
+	struct fscc_descriptor *descriptor = 0;
+
+	if (!handle)
+		return 0;
+
+	descriptor = phys_to_virt((phys_addr_t)handle);
+
+	if (descriptor->control == 0 && descriptor->data_count == 0)
+		return 0;
+
+	return descriptor;
+}
+
+/* Bytes coming in off the (looped back) line. */
+static void channel_receive(struct fscc_emulated_channel *channel,
+							const char *data, unsigned length)
+{
+	unsigned received = 0;
+
+	if (length == 0)
+		return;
+
+	if (channel->rx_length == 0 && !channel_is_streaming(channel))
+		channel->isr |= RFS;
+
+	received = fifo_push(&channel->rx, data, length);
+
+	if (received < length)
+		channel->isr |= RDO;
+
+	if (!channel_is_streaming(channel))
+		channel->rx_length += received;
+}
+
+static void channel_frame_end(struct fscc_emulated_channel *channel)
+{
+	char status[STATUS_LENGTH] = { EMULATED_RX_STATUS & 0xff,
+								   EMULATED_RX_STATUS >> 8 };
+
+	if (channel_is_streaming(channel))
+		return;
+
+	channel->rx_length += fifo_push(&channel->rx, status, STATUS_LENGTH);
+
+	if (counts_push(&channel->rx_counts, channel->rx_length))
+		channel->isr |= RFE;
+	else
+		channel->isr |= RFO;
+
+	channel->rx_length = 0;
+}
+
+/* Moves up to budget bytes across the line. */
+static void channel_run(struct fscc_emulated_channel *channel, unsigned budget)
+{
+	__u32 fifot = channel->registers[FIFOT_OFFSET / 4];
+	unsigned rx_trigger = fifot & FIFOT_RX_MASK;
+	unsigned tx_trigger = (fifot >> FIFOT_TX_SHIFT) & FIFOT_TX_MASK;
+	unsigned rx_before = channel->rx.count;
+	unsigned tx_before = channel->tx.count;
+	char chunk[64];
+
+	while (budget) {
+		if (channel->dma_descriptor) {
+			struct fscc_descriptor *descriptor = channel->dma_descriptor;
+			char *data = phys_to_virt((phys_addr_t)le32_to_cpu(descriptor->data_address));
+			unsigned length = 0;
+			__u32 control = 0;
+
+			length = min_t(unsigned, budget,
+						   descriptor->data_count - channel->dma_offset);
+
+			channel_receive(channel, data + channel->dma_offset, length);
+			channel->dma_offset += length;
+			budget -= length;
+
+			if (channel->dma_offset < descriptor->data_count)
+				continue;
+
+			control = descriptor->control;
+
+			descriptor->control = DESC_CSTOP_BIT;
+			channel->dma_offset = 0;
+			channel->dma_descriptor =
+				descriptor_at(le32_to_cpu(descriptor->next_descriptor));
+
+			if (control & DESC_FE_BIT) {
+				channel_frame_end(channel);
+				channel->isr |= DT_FE;
+
+				if (control & DESC_HI_BIT)
+					channel->isr |= DT_HI;
+			}
+		}
+		else if (channel->tx_counts.count) {
+			unsigned frame_length = counts_peek(&channel->tx_counts);
+			unsigned length = 0;
+
+			length = min_t(unsigned, budget, frame_length - channel->tx_sent);
+			length = min_t(unsigned, length, channel->tx.count);
+			length = min_t(unsigned, length, sizeof(chunk));
+
+			/* Waiting on the driver to refill the FIFO. */
+			if (length == 0 && channel->tx_sent < frame_length)
+				break;
+
+			fifo_pop(&channel->tx, chunk, length);
+			channel_receive(channel, chunk, length);
+			channel->tx_sent += length;
+			budget -= length;
+
+			if (channel->tx_sent == frame_length) {
+				counts_pop(&channel->tx_counts);
+				channel->tx_sent = 0;
+				channel_frame_end(channel);
+			}
+		}
+		else {
+			break;
+		}
+	}
+
+	if (tx_before > tx_trigger && channel->tx.count <= tx_trigger)
+		channel->isr |= TFT;
+
+	if (rx_before < rx_trigger && channel->rx.count >= rx_trigger)
+		channel->isr |= RFT;
+
+	if (channel->tx_active && channel_tx_idle(channel)) {
+		channel->tx_active = 0;
+		channel->isr |= ALLS;
+	}
+}
+
+/* Must be called with the model's lock held. */
+static void line_start(struct fscc_emulated *emulated)
+{
+	if (emulated->line_running || emulated->stopped)
+		return;
+
+	emulated->line_running = 1;
+	emulated->line_time = fscc_latency_now();
+
+	hrtimer_start(&emulated->line_timer, ns_to_ktime(EMULATED_TICK),
+				  HRTIMER_MODE_REL);
+}
+
+static enum hrtimer_restart line_timer_handler(struct hrtimer *timer)
+{
+	struct fscc_emulated *emulated = 0;
+	struct fscc_port *port = 0;
+	unsigned pending[2] = { 0, 0 };
+	unsigned long flags = 0;
+	unsigned restart = 0;
+	unsigned budget = 0;
+	__u64 now = 0;
+	unsigned i = 0;
+
+	emulated = container_of(timer, struct fscc_emulated, line_timer);
+
+	spin_lock_irqsave(&emulated->lock, flags);
+
+	now = fscc_latency_now();
+	budget = div_u64_rem((now - emulated->line_time) * emulated_line_rate +
+						 emulated->line_remainder, NSEC_PER_SEC,
+						 &emulated->line_remainder);
+	emulated->line_time = now;
+
+	for (i = 0; i < 2; i++) {
+		struct fscc_emulated_channel *channel = &emulated->channels[i];
+
+		channel_run(channel, budget);
+
+		if (channel->isr & ~channel->registers[IMR_OFFSET / 4])
+			pending[i] = 1;
+
+		if (!channel_tx_idle(channel))
+			restart = 1;
+	}
+
+	if (emulated->stopped)
+		restart = 0;
+
+	emulated->line_running = restart;
+
+	spin_unlock_irqrestore(&emulated->lock, flags);
+
+	/* Delivered like a real interrupt, without the model's lock held. */
+	list_for_each_entry(port, &emulated->card->ports, list) {
+		if (!pending[port->channel])
+			continue;
+
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(2, 6, 19)
+		fscc_isr(0, port);
+#else
+		fscc_isr(0, port, 0);
+#endif
+	}
+
+	if (!restart)
+		return HRTIMER_NORESTART;
+
+	hrtimer_forward_now(timer, ns_to_ktime(EMULATED_TICK));
+
+	return HRTIMER_RESTART;
+}
+
+static __u32 get_fcore_register(struct fscc_emulated_channel *channel,
+								unsigned offset)
+{
+	__u32 value = 0;
+
+	switch (offset) {
+	case FIFO_OFFSET:
+		fifo_pop(&channel->rx, (char *)&value, 4);
+		return le32_to_cpu(value);
+
+	case BC_FIFO_L_OFFSET:
+		return counts_pop(&channel->rx_counts);
+
+	case FIFO_BC_OFFSET:
+		return (channel->tx.count << 16) | channel->rx.count;
+
+	case FIFO_FC_OFFSET:
+		return (channel->tx_counts.count << 16) | channel->rx_counts.count;
+
+	case STAR_OFFSET:
+		return 0; /* Clock present, nothing pending */
+
+	case ISR_OFFSET:
+		value = channel->isr & ~channel->registers[IMR_OFFSET / 4];
+		channel->isr &= ~value;
+		return value;
+
+	case VSTR_OFFSET:
+		return EMULATED_VSTR;
+
+	default:
+		return channel->registers[offset / 4];
+	}
+}
+
+static void set_fcore_register(struct fscc_emulated *emulated,
+							   struct fscc_emulated_channel *channel,
+							   unsigned offset, __u32 value)
+{
+	switch (offset) {
+	case FIFO_OFFSET:
+		value = cpu_to_le32(value);
+		fifo_push(&channel->tx, (char *)&value, 4);
+		break;
+
+	case BC_FIFO_L_OFFSET:
+		counts_push(&channel->tx_counts, value);
+		channel->tx_active = 1;
+		line_start(emulated);
+		break;
+
+	case CMDR_OFFSET:
+		if (value & 0x08000000) { /* TRES */
+			fifo_clear(&channel->tx);
+			counts_clear(&channel->tx_counts);
+			channel->tx_sent = 0;
+		}
+
+		if (value & 0x00020000) { /* RRES */
+			fifo_clear(&channel->rx);
+			counts_clear(&channel->rx_counts);
+			channel->rx_length = 0;
+		}
+
+		if (value & 0x01000000) /* XF */
+			line_start(emulated);
+
+		break;
+
+	case FIFO_BC_OFFSET:
+	case FIFO_FC_OFFSET:
+	case STAR_OFFSET:
+	case ISR_OFFSET:
+	case VSTR_OFFSET:
+		break;
+
+	default:
+		channel->registers[offset / 4] = value;
+		break;
+	}
+}
+
+static __u32 get_dma_register(struct fscc_emulated *emulated, unsigned offset)
+{
+	struct fscc_emulated_channel *channels = emulated->channels;
+
+	switch (offset) {
+	case FCR_OFFSET:
+		return emulated->fcr;
+
+	case DMACCR_OFFSET:
+	case DMACCR_OFFSET + 0x04:
+		return channels[offset != DMACCR_OFFSET].dmaccr;
+
+	case DMA_RX_BASE_OFFSET:
+	case DMA_RX_BASE_OFFSET + 0x08:
+		return channels[offset != DMA_RX_BASE_OFFSET].dma_rx_base;
+
+	case DMA_TX_BASE_OFFSET:
+	case DMA_TX_BASE_OFFSET + 0x08:
+		return channels[offset != DMA_TX_BASE_OFFSET].dma_tx_base;
+
+	case DMA_CURRENT_TX_BASE_OFFSET:
+	case DMA_CURRENT_TX_BASE_OFFSET + 0x08: {
+			struct fscc_emulated_channel *channel =
+				&channels[offset != DMA_CURRENT_TX_BASE_OFFSET];
+
+			if (!channel->dma_descriptor)
+				return 0;
+
+			return (__u32)virt_to_phys(channel->dma_descriptor);
+		}
+
+	default:
+		return 0;
+	}
+}
+
+static void set_dma_register(struct fscc_emulated *emulated, unsigned offset,
+							 __u32 value)
+{
+	struct fscc_emulated_channel *channel = 0;
+
+	switch (offset) {
+	case FCR_OFFSET:
+		emulated->fcr = value;
+		break;
+
+	case DMACCR_OFFSET:
+	case DMACCR_OFFSET + 0x04:
+		channel = &emulated->channels[offset != DMACCR_OFFSET];
+		channel->dmaccr = value;
+
+		if (value & 0x00000220) { /* RST_T, STOP_T */
+			channel->dma_descriptor = 0;
+			channel->dma_offset = 0;
+		}
+		else if (value & 0x00000002) { /* Start transmitting */
+			channel->dma_descriptor = descriptor_at(channel->dma_tx_base);
+			channel->dma_offset = 0;
+			channel->tx_active = 1;
+			line_start(emulated);
+		}
+
+		break;
+
+	case DMA_RX_BASE_OFFSET:
+	case DMA_RX_BASE_OFFSET + 0x08:
+		emulated->channels[offset != DMA_RX_BASE_OFFSET].dma_rx_base = value;
+		break;
+
+	case DMA_TX_BASE_OFFSET:
+	case DMA_TX_BASE_OFFSET + 0x08:
+		emulated->channels[offset != DMA_TX_BASE_OFFSET].dma_tx_base = value;
+		break;
+
+	default:
+		break;
+	}
+}
+
+__u32 fscc_emulated_get_register(struct fscc_emulated *emulated, unsigned bar,
+								 unsigned offset)
+{
+	unsigned long flags = 0;
+	__u32 value = 0;
+
+	return_val_if_untrue(emulated, 0);
+
+	spin_lock_irqsave(&emulated->lock, flags);
+
+	if (bar == 0)
+		value = get_fcore_register(&emulated->channels[offset >= 0x80],
+								   offset & 0x7f);
+	else if (bar == 2)
+		value = get_dma_register(emulated, offset);
+
+	spin_unlock_irqrestore(&emulated->lock, flags);
+
+	return value;
+}
+
+void fscc_emulated_set_register(struct fscc_emulated *emulated, unsigned bar,
+								unsigned offset, __u32 value)
+{
+	unsigned long flags = 0;
+
+	return_if_untrue(emulated);
+
+	spin_lock_irqsave(&emulated->lock, flags);
+
+	if (bar == 0)
+		set_fcore_register(emulated, &emulated->channels[offset >= 0x80],
+						   offset & 0x7f, value);
+	else if (bar == 2)
+		set_dma_register(emulated, offset, value);
+
+	spin_unlock_irqrestore(&emulated->lock, flags);
+}
+
+void fscc_emulated_get_register_rep(struct fscc_emulated *emulated,
+									unsigned bar, unsigned offset, char *buf,
+									unsigned byte_count)
+{
+	unsigned long flags = 0;
+	unsigned i = 0;
+
+	return_if_untrue(emulated);
+
+	/* FIFO reads take exactly the bytes asked for, the model has no words. */
+	if (bar == 0 && (offset & 0x7f) == FIFO_OFFSET) {
+		struct fscc_emulated_channel *channel = &emulated->channels[offset >= 0x80];
+		unsigned popped = 0;
+
+		spin_lock_irqsave(&emulated->lock, flags);
+		popped = fifo_pop(&channel->rx, buf, byte_count);
+		spin_unlock_irqrestore(&emulated->lock, flags);
+
+		memset(buf + popped, 0, byte_count - popped);
+
+		return;
+	}
+
+	for (i = 0; i < byte_count; i += 4) {
+		__u32 value = fscc_emulated_get_register(emulated, bar, offset);
+
+		memcpy(buf + i, &value, min_t(unsigned, 4, byte_count - i));
+	}
+}
+
+void fscc_emulated_set_register_rep(struct fscc_emulated *emulated,
+									unsigned bar, unsigned offset,
+									const char *data, unsigned byte_count)
+{
+	unsigned long flags = 0;
+	unsigned i = 0;
+
+	return_if_untrue(emulated);
+
+	if (bar == 0 && (offset & 0x7f) == FIFO_OFFSET) {
+		struct fscc_emulated_channel *channel = &emulated->channels[offset >= 0x80];
+
+		spin_lock_irqsave(&emulated->lock, flags);
+		fifo_push(&channel->tx, data, byte_count);
+		spin_unlock_irqrestore(&emulated->lock, flags);
+
+		return;
+	}
+
+	for (i = 0; i < byte_count; i += 4) {
+		__u32 value = 0;
+
+		memcpy(&value, data + i, min_t(unsigned, 4, byte_count - i));
+		fscc_emulated_set_register(emulated, bar, offset, value);
+	}
+}
+
+struct device *fscc_emulated_get_device(struct fscc_emulated *emulated)
+{
+	return_val_if_untrue(emulated, 0);
+
+	return emulated->device;
+}
+
+static struct fscc_card *fscc_emulated_card_new(unsigned number,
+												unsigned major_number,
+												struct class *class,
+												struct file_operations *fops)
+{
+	struct fscc_card *card = 0;
+	struct fscc_emulated *emulated = 0;
+	char name[20];
+	unsigned i = 0;
+
+	card = kmalloc(sizeof(*card), GFP_KERNEL);
+
+	return_val_if_untrue(card != NULL, 0);
+
+	emulated = kmalloc(sizeof(*emulated), GFP_KERNEL);
+
+	if (emulated == NULL) {
+		kfree(card);
+		return 0;
+	}
+
+	memset(card, 0, sizeof(*card));
+	memset(emulated, 0, sizeof(*emulated));
+
+	INIT_LIST_HEAD(&card->list);
+	INIT_LIST_HEAD(&card->ports);
+
+	card->dma = (emulated_dma) ? 1 : 0;
+	card->emulated = emulated;
+	emulated->card = card;
+
+	spin_lock_init(&emulated->lock);
+
+	hrtimer_init(&emulated->line_timer, CLOCK_MONOTONIC, HRTIMER_MODE_REL);
+	emulated->line_timer.function = &line_timer_handler;
+
+	for (i = 0; i < 2; i++) {
+		struct fscc_emulated_channel *channel = &emulated->channels[i];
+
+		channel->rx.data = channel->rx_data;
+		channel->rx.size = EMULATED_RX_FIFO_SIZE;
+		channel->tx.data = channel->tx_data;
+		channel->tx.size = EMULATED_TX_FIFO_SIZE;
+	}
+
+	snprintf(name, sizeof(name), "fscc_emulated%u", number);
+
+	emulated->device = root_device_register(name);
+
+	if (IS_ERR(emulated->device)) {
+		printk(KERN_ERR DEVICE_NAME " root_device_register failed\n");
+		kfree(emulated);
+		kfree(card);
+		return 0;
+	}
+
+	/* Descriptors only hold 32 bit addresses. */
+	emulated->device->coherent_dma_mask = DMA_BIT_MASK(32);
+	emulated->device->dma_mask = &emulated->device->coherent_dma_mask;
+
+	fscc_card_create_ports(card, major_number, class, fops);
+
+	return card;
+}
+
+unsigned fscc_emulated_create_cards(struct list_head *card_list,
+									unsigned major_number,
+									struct class *class,
+									struct file_operations *fops)
+{
+	struct fscc_card *card = 0;
+	unsigned created = 0;
+	unsigned i = 0;
+
+	for (i = 0; i < emulated_cards; i++) {
+		card = fscc_emulated_card_new(i, major_number, class, fops);
+
+		if (!card)
+			continue;
+
+		list_add_tail(&card->list, card_list);
+		created++;
+	}
+
+	if (created) {
+		printk(KERN_INFO DEVICE_NAME " emulating %u card(s) at %u bytes/s\n",
+			   created, emulated_line_rate);
+	}
+
+	return created;
+}
+
+void fscc_emulated_stop(struct fscc_emulated *emulated)
+{
+	unsigned long flags = 0;
+
+	return_if_untrue(emulated);
+
+	spin_lock_irqsave(&emulated->lock, flags);
+	emulated->stopped = 1;
+	spin_unlock_irqrestore(&emulated->lock, flags);
+
+	hrtimer_cancel(&emulated->line_timer);
+}
+
+void fscc_emulated_delete(struct fscc_emulated *emulated)
+{
+	return_if_untrue(emulated);
+
+	fscc_emulated_stop(emulated);
+
+	root_device_unregister(emulated->device);
+
+	kfree(emulated);
+}
+
+module_param(emulated_cards, uint, S_IRUSR | S_IRGRP | S_IROTH);
+MODULE_PARM_DESC(emulated_cards, "Number of emulated cards to create.");
+
+module_param(emulated_dma, uint, S_IRUSR | S_IRGRP | S_IROTH);
+MODULE_PARM_DESC(emulated_dma, "Whether emulated cards have DMA (SuperFSCC) or only FIFOs (FSCC).");
+
+module_param(emulated_line_rate, uint, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+MODULE_PARM_DESC(emulated_line_rate, "Bytes per second each emulated port moves across its loopback.");
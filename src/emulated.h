@@ -0,0 +1,56 @@
+/*
+	Copyright (C) 2014 Commtech, Inc.
+
+	This file is part of fscc-linux.
+
+	fscc-linux is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	fscc-linux is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with fscc-linux.	If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef FSCC_EMULATED_H
+#define FSCC_EMULATED_H
+
+#include <linux/list.h> /* struct list_head */
+#include <linux/fs.h> /* struct file_operations */
+#include <linux/device.h> /* struct device, struct class */
+
+#define EMULATED_RX_FIFO_SIZE 8192
+#define EMULATED_TX_FIFO_SIZE 4096
+#define EMULATED_MAX_FRAMES 64 /* Byte counts each direction can hold */
+#define EMULATED_TICK 100000 /* Line timer period (ns) */
+#define EMULATED_VSTR 0x000f0700
+
+struct fscc_emulated;
+
+unsigned fscc_emulated_create_cards(struct list_head *card_list,
+									unsigned major_number,
+									struct class *class,
+									struct file_operations *fops);
+
+void fscc_emulated_stop(struct fscc_emulated *emulated);
+void fscc_emulated_delete(struct fscc_emulated *emulated);
+struct device *fscc_emulated_get_device(struct fscc_emulated *emulated);
+
+__u32 fscc_emulated_get_register(struct fscc_emulated *emulated, unsigned bar,
+								 unsigned offset);
+void fscc_emulated_set_register(struct fscc_emulated *emulated, unsigned bar,
+								unsigned offset, __u32 value);
+void fscc_emulated_get_register_rep(struct fscc_emulated *emulated,
+									unsigned bar, unsigned offset, char *buf,
+									unsigned byte_count);
+void fscc_emulated_set_register_rep(struct fscc_emulated *emulated,
+									unsigned bar, unsigned offset,
+									const char *data, unsigned byte_count);
+
+#endif
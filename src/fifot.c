@@ -0,0 +1,278 @@
+/*
+	Copyright (C) 2014 Commtech, Inc.
+
+	This file is part of fscc-linux.
+
+	fscc-linux is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	fscc-linux is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with fscc-linux.	If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include <linux/jiffies.h> /* jiffies, msecs_to_jiffies */
+#include <linux/version.h> /* LINUX_VERSION_CODE, KERNEL_VERSION */
+
+#include "fifot.h"
+#include "port.h" /* struct fscc_port */
+#include "utils.h" /* return_{val_}if_untrue */
+#include "config.h" /* DEFAULT_FIFOT_* */
+
+/*
+	Adaptive trigger levels. Every FSCC_FIFOT_ADAPT_INTERVAL the counters in
+	the port statistics are compared with the last sample and the trigger
+	levels are nudged within the user's bounds:
+
+	- A receive overflow halves the receive trigger and caps how high it may
+	  climb again. The cap slowly relaxes while there are no overflows.
+	- Too many receive trigger interrupts, each of them finding the FIFO filled
+	  to the trigger level, doubles the receive trigger.
+	- Stream data arriving without ever reaching the trigger level halves it,
+	  so the flush timer isn't the only thing delivering it.
+	- A transmit underrun doubles the transmit trigger so the FIFO is refilled
+	  earlier, too many transmit trigger interrupts halves it.
+*/
+
+static unsigned clamp_level(unsigned value, int min, int max)
+{
+	value -= value % 4;
+
+	if (value < (unsigned)min)
+		value = min;
+
+	if (value > (unsigned)max)
+		value = max;
+
+	return value;
+}
+
+unsigned fscc_fifot_get_rx(struct fscc_port *port)
+{
+	return_val_if_untrue(port, 0);
+
+	return (unsigned)port->register_storage.FIFOT & FIFOT_RX_MASK;
+}
+
+unsigned fscc_fifot_get_tx(struct fscc_port *port)
+{
+	return_val_if_untrue(port, 0);
+
+	return ((unsigned)port->register_storage.FIFOT >> FIFOT_TX_SHIFT) &
+		   FIFOT_TX_MASK;
+}
+
+/* Called with board_settings_spinlock held so a user's FIFOT write can't land
+   between reading the register storage and writing it back. */
+static void adjust_levels(struct fscc_port *port, struct fscc_stats *now,
+						  struct fscc_stats *last)
+{
+	__u64 rft = 0;
+	__u64 rx_bytes = 0;
+	__u64 overflows = 0;
+	__u64 tft = 0;
+	__u64 tdu = 0;
+	__u64 max_interrupts = 0;
+	unsigned rx = 0;
+	unsigned tx = 0;
+	__u32 fifot = 0;
+
+	rft = now->rft - last->rft;
+	rx_bytes = now->rx_bytes - last->rx_bytes;
+	overflows = (now->rdo - last->rdo) + (now->rfo - last->rfo) +
+				(now->rfl - last->rfl);
+	tft = now->tft - last->tft;
+	tdu = now->tdu - last->tdu;
+
+	max_interrupts = FSCC_FIFOT_TARGET_IRQ_RATE * FSCC_FIFOT_ADAPT_INTERVAL / 1000;
+
+	rx = fscc_fifot_get_rx(port);
+	tx = fscc_fifot_get_tx(port);
+
+	if (overflows) {
+		rx /= 2;
+		port->fifot_rx_ceiling = max(rx, (unsigned)port->fifot_adapt.rx_min);
+	}
+	else {
+		port->fifot_rx_ceiling = min(port->fifot_rx_ceiling +
+									 port->fifot_rx_ceiling / 8 + 4,
+									 (unsigned)port->fifot_adapt.rx_max);
+
+		if (rft > max_interrupts && rx_bytes >= rft * rx)
+			rx = min(rx * 2, port->fifot_rx_ceiling);
+		else if (fscc_port_is_streaming(port) && rft == 0 && rx_bytes > 0)
+			rx /= 2;
+	}
+
+	if (tdu)
+		tx *= 2;
+	else if (tft > max_interrupts)
+		tx /= 2;
+
+	rx = clamp_level(rx, port->fifot_adapt.rx_min, port->fifot_adapt.rx_max);
+	tx = clamp_level(tx, port->fifot_adapt.tx_min, port->fifot_adapt.tx_max);
+
+	fifot = (__u32)port->register_storage.FIFOT;
+	fifot &= ~(FIFOT_RX_MASK | (FIFOT_TX_MASK << FIFOT_TX_SHIFT));
+	fifot |= rx | (tx << FIFOT_TX_SHIFT);
+
+	if (fifot != (__u32)port->register_storage.FIFOT)
+		fscc_port_set_register(port, 0, FIFOT_OFFSET, fifot);
+}
+
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(4, 15, 0)
+static void fscc_fifot_adapt_timer(struct timer_list *timer)
+{
+	struct fscc_port *port = from_timer(port, timer, fifot_timer);
+#else
+static void fscc_fifot_adapt_timer(unsigned long data)
+{
+	struct fscc_port *port = (struct fscc_port *)data;
+#endif
+	struct fscc_stats now;
+	unsigned long flags;
+
+	if (!port->fifot_adapt.enabled)
+		return;
+
+	fscc_port_get_stats(port, &now);
+
+	/* A FIFOT value the user wrote is left alone until adaptation is turned
+	   on again, the counters keep being sampled so that picks up from now. */
+	spin_lock_irqsave(&port->board_settings_spinlock, flags);
+
+	if (!port->fifot_pinned)
+		adjust_levels(port, &now, &port->fifot_last);
+
+	spin_unlock_irqrestore(&port->board_settings_spinlock, flags);
+
+	port->fifot_last = now;
+
+	mod_timer(&port->fifot_timer,
+			  jiffies + msecs_to_jiffies(FSCC_FIFOT_ADAPT_INTERVAL));
+}
+
+void fscc_fifot_init(struct fscc_port *port)
+{
+	return_if_untrue(port);
+
+	port->fifot_adapt.enabled = DEFAULT_FIFOT_ADAPT_VALUE;
+	port->fifot_adapt.rx_min = DEFAULT_FIFOT_RX_MIN_VALUE;
+	port->fifot_adapt.rx_max = DEFAULT_FIFOT_RX_MAX_VALUE;
+	port->fifot_adapt.tx_min = DEFAULT_FIFOT_TX_MIN_VALUE;
+	port->fifot_adapt.tx_max = DEFAULT_FIFOT_TX_MAX_VALUE;
+	port->fifot_rx_ceiling = DEFAULT_FIFOT_RX_MAX_VALUE;
+	port->fifot_pinned = 0;
+
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(4, 15, 0)
+	timer_setup(&port->fifot_timer, &fscc_fifot_adapt_timer, 0);
+#else
+	setup_timer(&port->fifot_timer, &fscc_fifot_adapt_timer,
+				(unsigned long)port);
+#endif
+}
+
+/*
+	Called with board_settings_spinlock held whenever the user writes FIFOT
+	directly. Adaptation stops touching the register until it is enabled
+	again.
+*/
+void fscc_fifot_pin(struct fscc_port *port)
+{
+	return_if_untrue(port);
+
+	if (port->fifot_adapt.enabled && !port->fifot_pinned)
+		dev_dbg(port->device, "fifot adapt paused (fifot written)\n");
+
+	port->fifot_pinned = 1;
+}
+
+void fscc_fifot_stop(struct fscc_port *port)
+{
+	return_if_untrue(port);
+
+	port->fifot_adapt.enabled = 0;
+	del_timer_sync(&port->fifot_timer);
+}
+
+/*
+	Negative values are left unchanged. Returns -EINVAL if the bounds don't
+	fit in the FIFOs or the minimum is larger than the maximum.
+*/
+int fscc_fifot_set_adapt(struct fscc_port *port,
+						 struct fscc_fifot_adapt *value)
+{
+	struct fscc_fifot_adapt new_value;
+	unsigned long flags;
+
+	return_val_if_untrue(port, 0);
+	return_val_if_untrue(value, 0);
+
+	new_value = port->fifot_adapt;
+
+	if (value->enabled >= 0)
+		new_value.enabled = (value->enabled) ? 1 : 0;
+
+	if (value->rx_min >= 0)
+		new_value.rx_min = value->rx_min;
+
+	if (value->rx_max >= 0)
+		new_value.rx_max = value->rx_max;
+
+	if (value->tx_min >= 0)
+		new_value.tx_min = value->tx_min;
+
+	if (value->tx_max >= 0)
+		new_value.tx_max = value->tx_max;
+
+	if (new_value.rx_min > new_value.rx_max ||
+		new_value.rx_max > FIFOT_RX_MASK ||
+		new_value.tx_min > new_value.tx_max ||
+		new_value.tx_max > FIFOT_TX_MASK) {
+		dev_warn(port->device, "fifot adapt (invalid bounds)\n");
+		return -EINVAL;
+	}
+
+	dev_dbg(port->device, "fifot adapt %i (rx %i-%i, tx %i-%i)\n",
+			new_value.enabled, new_value.rx_min, new_value.rx_max,
+			new_value.tx_min, new_value.tx_max);
+
+	if (port->fifot_adapt.enabled && !new_value.enabled)
+		fscc_fifot_stop(port);
+
+	if (!port->fifot_adapt.enabled && new_value.enabled) {
+		fscc_port_get_stats(port, &port->fifot_last);
+		port->fifot_rx_ceiling = new_value.rx_max;
+	}
+
+	/* Asking for adaptation again takes back a FIFOT value the user pinned. */
+	if (value->enabled > 0) {
+		spin_lock_irqsave(&port->board_settings_spinlock, flags);
+		port->fifot_pinned = 0;
+		spin_unlock_irqrestore(&port->board_settings_spinlock, flags);
+	}
+
+	port->fifot_adapt = new_value;
+
+	if (port->fifot_adapt.enabled)
+		mod_timer(&port->fifot_timer,
+				  jiffies + msecs_to_jiffies(FSCC_FIFOT_ADAPT_INTERVAL));
+
+	return 1;
+}
+
+void fscc_fifot_get_adapt(struct fscc_port *port,
+						  struct fscc_fifot_adapt *value)
+{
+	return_if_untrue(port);
+	return_if_untrue(value);
+
+	*value = port->fifot_adapt;
+}
@@ -0,0 +1,50 @@
+/*
+	Copyright (C) 2014 Commtech, Inc.
+
+	This file is part of fscc-linux.
+
+	fscc-linux is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	fscc-linux is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with fscc-linux.	If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef FSCC_FIFOT_H
+#define FSCC_FIFOT_H
+
+#include <linux/timer.h> /* struct timer_list */
+
+/* FIFOT holds the receive trigger level in the low bits and the transmit
+   trigger level in the high half. */
+#define FIFOT_RX_MASK 0x00001fff
+#define FIFOT_TX_SHIFT 16
+#define FIFOT_TX_MASK 0x00000fff
+
+#define FSCC_FIFOT_ADAPT_INTERVAL 100 /* Milliseconds between adjustments */
+#define FSCC_FIFOT_TARGET_IRQ_RATE 2000 /* Trigger interrupts per second */
+
+struct fscc_port;
+struct fscc_fifot_adapt;
+
+void fscc_fifot_init(struct fscc_port *port);
+void fscc_fifot_stop(struct fscc_port *port);
+void fscc_fifot_pin(struct fscc_port *port);
+
+int fscc_fifot_set_adapt(struct fscc_port *port,
+						 struct fscc_fifot_adapt *value);
+void fscc_fifot_get_adapt(struct fscc_port *port,
+						  struct fscc_fifot_adapt *value);
+
+unsigned fscc_fifot_get_rx(struct fscc_port *port);
+unsigned fscc_fifot_get_tx(struct fscc_port *port);
+
+#endif
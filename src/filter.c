@@ -0,0 +1,139 @@
+/*
+	Copyright (C) 2014 Commtech, Inc.
+
+	This file is part of fscc-linux.
+
+	fscc-linux is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	fscc-linux is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with fscc-linux.	If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include <linux/slab.h> /* kmalloc */
+#include <linux/skbuff.h> /* alloc_skb, skb_put */
+#include <linux/version.h> /* LINUX_VERSION_CODE, KERNEL_VERSION */
+
+#include "filter.h"
+#include "frame.h" /* struct fscc_frame */
+#include "fscc.h" /* STATUS_LENGTH */
+#include "utils.h" /* return_{val_}if_untrue */
+
+/*
+	Classic BPF, checked and run by the kernel's own filter code. Programs
+	written for sockets expect an skb, so each frame is copied into one before
+	the program runs. The program sees the frame's data followed by its two
+	status bytes and returns how many data bytes to keep: 0 drops the frame,
+	anything shorter than the frame truncates it. The status bytes are always
+	kept.
+*/
+
+/* Copies the program in from user space and has the kernel check it. */
+struct fscc_filter *fscc_filter_new(const struct sock_fprog *fprog, int *error_code)
+{
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(4, 1, 0)
+	struct fscc_filter *filter = 0;
+	struct sock_fprog user_fprog = *fprog;
+
+	*error_code = -EINVAL;
+
+	return_val_if_untrue(fprog->len > 0 && fprog->len <= BPF_MAXINSNS, 0);
+
+	filter = kmalloc(sizeof(*filter), GFP_KERNEL);
+
+	if (!filter) {
+		*error_code = -ENOMEM;
+		return 0;
+	}
+
+	filter->length = fprog->len;
+
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(4, 6, 0)
+	*error_code = bpf_prog_create_from_user(&filter->prog, &user_fprog, NULL,
+											false);
+#else
+	*error_code = bpf_prog_create_from_user(&filter->prog, &user_fprog, NULL);
+#endif
+
+	if (*error_code < 0) {
+		kfree(filter);
+		return 0;
+	}
+
+	return filter;
+#else
+	*error_code = -EOPNOTSUPP;
+
+	return 0;
+#endif
+}
+
+void fscc_filter_delete(struct fscc_filter *filter)
+{
+	return_if_untrue(filter);
+
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(4, 1, 0)
+	bpf_prog_destroy(filter->prog);
+#endif
+
+	kfree(filter);
+}
+
+/*
+	Returns 0 if the frame should be dropped. A frame the filter keeps part of
+	is truncated in place with its status bytes moved up behind the data. A
+	frame that can't be copied for the program is kept.
+*/
+unsigned fscc_filter_frame(const struct fscc_filter *filter,
+						   struct fscc_frame *frame)
+{
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(4, 1, 0)
+	struct sk_buff *skb = 0;
+	unsigned frame_length = 0;
+	unsigned data_length = 0;
+	unsigned keep = 0;
+
+	return_val_if_untrue(filter, 1);
+
+	frame_length = fscc_frame_get_length(frame);
+
+	if (frame_length < STATUS_LENGTH)
+		return 1;
+
+	data_length = frame_length - STATUS_LENGTH;
+
+	skb = alloc_skb(frame_length, GFP_ATOMIC);
+
+	if (!skb)
+		return 1;
+
+	memcpy(skb_put(skb, frame_length), frame->buffer, frame_length);
+
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(5, 16, 0)
+	keep = bpf_prog_run(filter->prog, skb);
+#else
+	keep = BPF_PROG_RUN(filter->prog, skb);
+#endif
+
+	kfree_skb(skb);
+
+	if (keep == 0)
+		return 0;
+
+	if (keep < data_length) {
+		memmove(frame->buffer + keep, frame->buffer + data_length,
+				STATUS_LENGTH);
+		frame->data_length = keep + STATUS_LENGTH;
+	}
+#endif
+
+	return 1;
+}
@@ -0,0 +1,38 @@
+/*
+	Copyright (C) 2014 Commtech, Inc.
+
+	This file is part of fscc-linux.
+
+	fscc-linux is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	fscc-linux is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with fscc-linux.	If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef FSCC_FILTER_H
+#define FSCC_FILTER_H
+
+#include <linux/filter.h> /* struct bpf_prog, struct sock_fprog */
+
+struct fscc_frame;
+
+struct fscc_filter {
+	unsigned length; /* Instructions in the program the user gave */
+	struct bpf_prog *prog;
+};
+
+struct fscc_filter *fscc_filter_new(const struct sock_fprog *fprog, int *error_code);
+void fscc_filter_delete(struct fscc_filter *filter);
+unsigned fscc_filter_frame(const struct fscc_filter *filter,
+						   struct fscc_frame *frame);
+
+#endif
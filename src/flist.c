@@ -23,13 +23,16 @@
 #include "utils.h" /* return_{val_}if_true */
 #include "frame.h"
 #include "debug.h"
+#include "budget.h" /* fscc_budget_charge */
 
 
 void fscc_flist_init(struct fscc_flist *flist)
 {
 	INIT_LIST_HEAD(&flist->frames);
 
-	flist->estimated_memory_usage = 0;
+	flist->memory_usage = 0;
+	flist->data_length = 0;
+	flist->frame_count = 0;
 }
 
 void fscc_flist_delete(struct fscc_flist *flist)
@@ -43,7 +46,24 @@ void fscc_flist_add_frame(struct fscc_flist *flist, struct fscc_frame *frame)
 {
 	list_add_tail(&frame->list, &flist->frames);
 
-	flist->estimated_memory_usage += fscc_frame_get_length(frame);
+	frame->memory_usage = fscc_frame_get_memory_usage(frame);
+	flist->memory_usage += frame->memory_usage;
+	fscc_budget_charge(frame->port, frame->memory_usage);
+	flist->data_length += fscc_frame_get_length(frame);
+	flist->frame_count++;
+}
+
+/* Puts a frame taken from the front of the list back where it was. */
+void fscc_flist_add_frame_front(struct fscc_flist *flist,
+								struct fscc_frame *frame)
+{
+	list_add(&frame->list, &flist->frames);
+
+	frame->memory_usage = fscc_frame_get_memory_usage(frame);
+	flist->memory_usage += frame->memory_usage;
+	fscc_budget_charge(frame->port, frame->memory_usage);
+	flist->data_length += fscc_frame_get_length(frame);
+	flist->frame_count++;
 }
 
 struct fscc_frame *fscc_flist_peek_front(struct fscc_flist *flist)
@@ -73,7 +93,10 @@ struct fscc_frame *fscc_flist_remove_frame(struct fscc_flist *flist)
 
 	list_del(&frame->list);
 
-	flist->estimated_memory_usage -= fscc_frame_get_length(frame);
+	flist->memory_usage -= frame->memory_usage;
+	fscc_budget_charge(frame->port, -(int)frame->memory_usage);
+	flist->data_length -= fscc_frame_get_length(frame);
+	flist->frame_count--;
 
 	return frame;
 }
@@ -96,7 +119,10 @@ struct fscc_frame *fscc_flist_remove_frame_if_lte(struct fscc_flist *flist,
 
 	list_del(&frame->list);
 
-	flist->estimated_memory_usage -= fscc_frame_get_length(frame);
+	flist->memory_usage -= frame->memory_usage;
+	fscc_budget_charge(frame->port, -(int)frame->memory_usage);
+	flist->data_length -= fscc_frame_get_length(frame);
+	flist->frame_count--;
 
 	return frame;
 }
@@ -113,10 +139,14 @@ void fscc_flist_clear(struct fscc_flist *flist)
 
 		list_del(current_node);
 
+		fscc_budget_charge(current_frame->port,
+						   -(int)current_frame->memory_usage);
 		fscc_frame_delete(current_frame);
 	}
 
-	flist->estimated_memory_usage = 0;
+	flist->memory_usage = 0;
+	flist->data_length = 0;
+	flist->frame_count = 0;
 }
 
 unsigned fscc_flist_is_empty(struct fscc_flist *flist)
@@ -130,7 +160,7 @@ unsigned fscc_flist_calculate_memory_usage(struct fscc_flist *flist)
 	struct fscc_frame *current_frame = 0;
 
 	list_for_each_entry(current_frame, &flist->frames, list) {
-		memory += fscc_frame_get_length(current_frame);
+		memory += fscc_frame_get_memory_usage(current_frame);
 	}
 
 	return memory;
@@ -138,12 +168,11 @@ unsigned fscc_flist_calculate_memory_usage(struct fscc_flist *flist)
 
 unsigned fscc_flist_length(struct fscc_flist *flist)
 {
-	unsigned num_frames = 0;
-	struct fscc_frame *current_frame = 0;
-
-	list_for_each_entry(current_frame, &flist->frames, list) {
-		num_frames++;
-	}
+	return flist->frame_count;
+}
 
-	return num_frames;
+/* Frames can't change length while they are in a list or this drifts. */
+unsigned fscc_flist_get_data_length(struct fscc_flist *flist)
+{
+	return flist->data_length;
 }
@@ -34,12 +34,16 @@
 
 struct fscc_flist {
 	struct list_head frames;
-	unsigned estimated_memory_usage;
+	unsigned memory_usage; /* Bytes of kernel memory held by the frames */
+	unsigned data_length; /* Bytes of frame data */
+	unsigned frame_count;
 };
 
 void fscc_flist_init(struct fscc_flist *flist);
 void fscc_flist_delete(struct fscc_flist *flist);
 void fscc_flist_add_frame(struct fscc_flist *flist, struct fscc_frame *frame);
+void fscc_flist_add_frame_front(struct fscc_flist *flist,
+								struct fscc_frame *frame);
 struct fscc_frame *fscc_flist_remove_frame(struct fscc_flist *flist);
 struct fscc_frame *fscc_flist_remove_frame_if_lte(struct fscc_flist *flist, unsigned size);
 struct fscc_frame *fscc_flist_peek_front(struct fscc_flist *flist);
@@ -48,5 +52,6 @@ void fscc_flist_clear(struct fscc_flist *flist);
 unsigned fscc_flist_is_empty(struct fscc_flist *flist);
 unsigned fscc_flist_calculate_memory_usage(struct fscc_flist *flist);
 unsigned fscc_flist_length(struct fscc_flist *flist);
+unsigned fscc_flist_get_data_length(struct fscc_flist *flist);
 
 #endif
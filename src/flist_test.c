@@ -0,0 +1,291 @@
+/*
+	Copyright (C) 2014 Commtech, Inc.
+
+	This file is part of fscc-linux.
+
+	fscc-linux is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	fscc-linux is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with fscc-linux.	If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include <kunit/test.h>
+
+#include "frame.h" /* struct fscc_frame */
+#include "flist.h" /* struct fscc_flist */
+
+/*
+	Checks the frame list bookkeeping on frames that don't belong to a port.
+	The suite is linked into the module (make KUNIT=1) and runs when the module
+	is loaded, results show up in the kernel log and under
+	/sys/kernel/debug/kunit/fscc_flist.
+*/
+
+#define FSCC_FLIST_TEST_FRAMES 8
+
+static const char test_data[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+
+static struct fscc_frame *new_frame(struct kunit *test, unsigned length)
+{
+	struct fscc_frame *frame = 0;
+
+	frame = fscc_frame_new(0);
+	KUNIT_ASSERT_NOT_NULL(test, frame);
+
+	if (length)
+		KUNIT_ASSERT_EQ(test, fscc_frame_add_data(frame, test_data, length), 1);
+
+	return frame;
+}
+
+/* The running totals have to agree with a full walk of the list. */
+static void expect_accounting(struct kunit *test, struct fscc_flist *flist)
+{
+	struct fscc_frame *frame = 0;
+	unsigned frame_count = 0;
+	unsigned data_length = 0;
+
+	list_for_each_entry(frame, &flist->frames, list) {
+		frame_count++;
+		data_length += fscc_frame_get_length(frame);
+	}
+
+	KUNIT_EXPECT_EQ(test, fscc_flist_length(flist), frame_count);
+	KUNIT_EXPECT_EQ(test, fscc_flist_get_data_length(flist), data_length);
+	KUNIT_EXPECT_EQ(test, flist->memory_usage,
+	                fscc_flist_calculate_memory_usage(flist));
+	KUNIT_EXPECT_EQ(test, fscc_flist_is_empty(flist),
+	                (unsigned)(frame_count == 0));
+}
+
+static void fscc_flist_test_empty(struct kunit *test)
+{
+	struct fscc_flist flist;
+
+	fscc_flist_init(&flist);
+
+	KUNIT_EXPECT_TRUE(test, fscc_flist_is_empty(&flist));
+	KUNIT_EXPECT_NULL(test, fscc_flist_peek_front(&flist));
+	KUNIT_EXPECT_NULL(test, fscc_flist_peek_back(&flist));
+	KUNIT_EXPECT_NULL(test, fscc_flist_remove_frame(&flist));
+	KUNIT_EXPECT_NULL(test, fscc_flist_remove_frame_if_lte(&flist, ~0U));
+	expect_accounting(test, &flist);
+	KUNIT_EXPECT_EQ(test, flist.memory_usage, 0U);
+}
+
+static void fscc_flist_test_add_remove(struct kunit *test)
+{
+	struct fscc_frame *frames[FSCC_FLIST_TEST_FRAMES];
+	struct fscc_flist flist;
+	unsigned i = 0;
+
+	fscc_flist_init(&flist);
+
+	for (i = 0; i < FSCC_FLIST_TEST_FRAMES; i++) {
+		frames[i] = new_frame(test, i + 1);
+
+		fscc_flist_add_frame(&flist, frames[i]);
+
+		KUNIT_EXPECT_EQ(test, frames[i]->memory_usage,
+		                fscc_frame_get_memory_usage(frames[i]));
+		KUNIT_EXPECT_PTR_EQ(test, fscc_flist_peek_front(&flist), frames[0]);
+		KUNIT_EXPECT_PTR_EQ(test, fscc_flist_peek_back(&flist), frames[i]);
+		expect_accounting(test, &flist);
+	}
+
+	KUNIT_EXPECT_EQ(test, fscc_flist_length(&flist),
+	                (unsigned)FSCC_FLIST_TEST_FRAMES);
+	KUNIT_EXPECT_EQ(test, fscc_flist_get_data_length(&flist),
+	                (unsigned)(FSCC_FLIST_TEST_FRAMES *
+	                           (FSCC_FLIST_TEST_FRAMES + 1) / 2));
+
+	/* Frames come back out in the order they went in. */
+	for (i = 0; i < FSCC_FLIST_TEST_FRAMES; i++) {
+		struct fscc_frame *frame = fscc_flist_remove_frame(&flist);
+
+		KUNIT_EXPECT_PTR_EQ(test, frame, frames[i]);
+		expect_accounting(test, &flist);
+
+		fscc_frame_delete(frame);
+	}
+
+	KUNIT_EXPECT_TRUE(test, fscc_flist_is_empty(&flist));
+	KUNIT_EXPECT_EQ(test, flist.memory_usage, 0U);
+	KUNIT_EXPECT_EQ(test, flist.data_length, 0U);
+}
+
+/* A frame the reader couldn't copy goes back ahead of the others. */
+static void fscc_flist_test_add_front(struct kunit *test)
+{
+	struct fscc_frame *first = 0;
+	struct fscc_frame *second = 0;
+	struct fscc_frame *frame = 0;
+	struct fscc_flist flist;
+	unsigned memory_usage = 0;
+
+	fscc_flist_init(&flist);
+
+	first = new_frame(test, 6);
+	second = new_frame(test, 9);
+
+	fscc_flist_add_frame(&flist, first);
+	fscc_flist_add_frame(&flist, second);
+
+	memory_usage = flist.memory_usage;
+
+	frame = fscc_flist_remove_frame(&flist);
+	KUNIT_EXPECT_PTR_EQ(test, frame, first);
+
+	fscc_flist_add_frame_front(&flist, frame);
+
+	KUNIT_EXPECT_PTR_EQ(test, fscc_flist_peek_front(&flist), first);
+	KUNIT_EXPECT_PTR_EQ(test, fscc_flist_peek_back(&flist), second);
+	KUNIT_EXPECT_EQ(test, fscc_flist_length(&flist), 2U);
+	KUNIT_EXPECT_EQ(test, fscc_flist_get_data_length(&flist), 15U);
+	KUNIT_EXPECT_EQ(test, flist.memory_usage, memory_usage);
+	expect_accounting(test, &flist);
+
+	fscc_flist_clear(&flist);
+}
+
+static void fscc_flist_test_remove_if_lte(struct kunit *test)
+{
+	struct fscc_frame *small = 0;
+	struct fscc_frame *large = 0;
+	struct fscc_frame *frame = 0;
+	struct fscc_flist flist;
+
+	fscc_flist_init(&flist);
+
+	large = new_frame(test, 20);
+	small = new_frame(test, 4);
+
+	fscc_flist_add_frame(&flist, large);
+	fscc_flist_add_frame(&flist, small);
+
+	/* Only the front frame is looked at, a smaller one behind it waits. */
+	KUNIT_EXPECT_NULL(test, fscc_flist_remove_frame_if_lte(&flist, 19));
+	KUNIT_EXPECT_EQ(test, fscc_flist_length(&flist), 2U);
+	KUNIT_EXPECT_EQ(test, fscc_flist_get_data_length(&flist), 24U);
+	expect_accounting(test, &flist);
+
+	/* A reader exactly the size of the frame gets it. */
+	frame = fscc_flist_remove_frame_if_lte(&flist, 20);
+	KUNIT_EXPECT_PTR_EQ(test, frame, large);
+	KUNIT_EXPECT_EQ(test, fscc_flist_length(&flist), 1U);
+	KUNIT_EXPECT_EQ(test, fscc_flist_get_data_length(&flist), 4U);
+	KUNIT_EXPECT_EQ(test, flist.memory_usage, small->memory_usage);
+	expect_accounting(test, &flist);
+	fscc_frame_delete(frame);
+
+	frame = fscc_flist_remove_frame_if_lte(&flist, ~0U);
+	KUNIT_EXPECT_PTR_EQ(test, frame, small);
+	KUNIT_EXPECT_TRUE(test, fscc_flist_is_empty(&flist));
+	KUNIT_EXPECT_EQ(test, flist.memory_usage, 0U);
+	fscc_frame_delete(frame);
+}
+
+static void fscc_flist_test_resize(struct kunit *test)
+{
+	struct fscc_frame *frame = 0;
+	unsigned usage = 0;
+
+	frame = new_frame(test, 0);
+
+	usage = fscc_frame_get_memory_usage(frame);
+
+	/* Growing one chunk at a time keeps the earlier data. */
+	KUNIT_ASSERT_EQ(test, fscc_frame_add_data(frame, test_data, 10), 1);
+	KUNIT_ASSERT_EQ(test, fscc_frame_add_data(frame, test_data + 10, 10), 1);
+	KUNIT_EXPECT_EQ(test, fscc_frame_get_length(frame), 20U);
+	KUNIT_EXPECT_GE(test, frame->buffer_size, 20U);
+	KUNIT_EXPECT_MEMEQ(test, frame->buffer, test_data, 20);
+	KUNIT_EXPECT_GT(test, fscc_frame_get_memory_usage(frame), usage);
+
+	/* Shrinking the buffer truncates the data to fit. */
+	KUNIT_ASSERT_EQ(test, fscc_frame_update_buffer_size(frame, 8), 1);
+	KUNIT_EXPECT_EQ(test, frame->buffer_size, 8U);
+	KUNIT_EXPECT_EQ(test, fscc_frame_get_length(frame), 8U);
+	KUNIT_EXPECT_MEMEQ(test, frame->buffer, test_data, 8);
+
+	/* Removing from the front moves the rest of the data up. */
+	KUNIT_ASSERT_EQ(test, fscc_frame_remove_data(frame, 0, 3), 1);
+	KUNIT_EXPECT_EQ(test, fscc_frame_get_length(frame), 5U);
+	KUNIT_EXPECT_MEMEQ(test, frame->buffer, test_data + 3, 5);
+
+	KUNIT_ASSERT_EQ(test, fscc_frame_update_buffer_size(frame, 0), 1);
+	KUNIT_EXPECT_TRUE(test, fscc_frame_is_empty(frame));
+	KUNIT_EXPECT_NULL(test, frame->buffer);
+	KUNIT_EXPECT_EQ(test, fscc_frame_get_memory_usage(frame), usage);
+
+	fscc_frame_delete(frame);
+}
+
+/* The list charges what a frame held when it was added, not what it holds
+   when it leaves, so a list always drains back to zero. */
+static void fscc_flist_test_memory_accounting(struct kunit *test)
+{
+	struct fscc_frame *frames[FSCC_FLIST_TEST_FRAMES];
+	struct fscc_flist flist;
+	unsigned expected = 0;
+	unsigned i = 0;
+
+	fscc_flist_init(&flist);
+
+	for (i = 0; i < FSCC_FLIST_TEST_FRAMES; i++) {
+		frames[i] = new_frame(test, sizeof(test_data) - i);
+
+		fscc_flist_add_frame(&flist, frames[i]);
+
+		expected += fscc_frame_get_memory_usage(frames[i]);
+		KUNIT_EXPECT_EQ(test, flist.memory_usage, expected);
+	}
+
+	KUNIT_EXPECT_GE(test, flist.memory_usage,
+	                (unsigned)(FSCC_FLIST_TEST_FRAMES * sizeof(struct fscc_frame)));
+	expect_accounting(test, &flist);
+
+	for (i = 0; i < FSCC_FLIST_TEST_FRAMES / 2; i++) {
+		struct fscc_frame *frame = fscc_flist_remove_frame(&flist);
+
+		expected -= frame->memory_usage;
+		KUNIT_EXPECT_EQ(test, flist.memory_usage, expected);
+
+		fscc_frame_delete(frame);
+	}
+
+	expect_accounting(test, &flist);
+
+	fscc_flist_clear(&flist);
+
+	KUNIT_EXPECT_TRUE(test, fscc_flist_is_empty(&flist));
+	KUNIT_EXPECT_EQ(test, fscc_flist_length(&flist), 0U);
+	KUNIT_EXPECT_EQ(test, fscc_flist_get_data_length(&flist), 0U);
+	KUNIT_EXPECT_EQ(test, flist.memory_usage, 0U);
+}
+
+static struct kunit_case fscc_flist_test_cases[] = {
+	KUNIT_CASE(fscc_flist_test_empty),
+	KUNIT_CASE(fscc_flist_test_add_remove),
+	KUNIT_CASE(fscc_flist_test_add_front),
+	KUNIT_CASE(fscc_flist_test_remove_if_lte),
+	KUNIT_CASE(fscc_flist_test_resize),
+	KUNIT_CASE(fscc_flist_test_memory_accounting),
+	{}
+};
+
+static struct kunit_suite fscc_flist_test_suite = {
+	.name = "fscc_flist",
+	.test_cases = fscc_flist_test_cases,
+};
+
+kunit_test_suite(fscc_flist_test_suite);
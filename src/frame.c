@@ -19,16 +19,21 @@
 */
 
 #include <linux/slab.h> /* kmalloc */
+#include <linux/dmapool.h> /* dma_pool_* */
+#include <linux/mm.h> /* pin_user_pages_fast, unpin_user_page */
+#include <linux/highmem.h> /* kmap_atomic */
+#include <linux/version.h> /* LINUX_VERSION_CODE, KERNEL_VERSION */
 #include <linux/uaccess.h>
+#include <linux/log2.h> /* roundup_pow_of_two */
 
 #include "frame.h"
 #include "utils.h" /* return_{val_}if_true */
 #include "port.h" /* struct fscc_port */
 #include "card.h" /* struct fscc_card */
 
-static unsigned frame_counter = 1;
 
-int fscc_frame_update_buffer_size(struct fscc_frame *frame, unsigned length);
+void fscc_frame_release_user_pages(struct fscc_frame *frame);
+static void fscc_frame_release_zero_copy(struct fscc_frame *frame);
 
 struct fscc_frame *fscc_frame_new(struct fscc_port *port)
 {
@@ -49,9 +54,6 @@ struct fscc_frame *fscc_frame_new(struct fscc_port *port)
 	frame->dma_initialized = 0;
 	frame->port = port;
 
-	frame->number = frame_counter;
-	frame_counter += 1;
-
 	return frame;
 }
 
@@ -59,14 +61,15 @@ void fscc_frame_delete(struct fscc_frame *frame)
 {
 	return_if_untrue(frame);
 
-	if (frame->dma_initialized) {
-		pci_unmap_single(frame->port->card->pci_dev, frame->data_handle,
-						 frame->data_length, DMA_TO_DEVICE);
-
-		pci_unmap_single(frame->port->card->pci_dev, frame->d1_handle,
-						 sizeof(*frame->d1), DMA_TO_DEVICE);
+	if (frame->segments) {
+		fscc_frame_release_zero_copy(frame);
+	}
+	else if (frame->dma_initialized) {
+		dma_unmap_single(fscc_card_get_device(frame->port->card),
+						 frame->data_handle, frame->data_length, DMA_TO_DEVICE);
 
-		kfree(frame->d1);
+		dma_pool_free(frame->port->descriptor_pool, frame->d1,
+		              frame->d1_handle);
 	}
 
 	fscc_frame_update_buffer_size(frame, 0);
@@ -88,6 +91,73 @@ unsigned fscc_frame_get_buffer_size(struct fscc_frame *frame)
 	return frame->buffer_size;
 }
 
+/*
+	Returns the number of bytes of kernel memory the frame is holding. This
+	includes the frame structure, the allocator's slack on the data buffer and
+	the DMA descriptor.
+*/
+unsigned fscc_frame_get_memory_usage(struct fscc_frame *frame)
+{
+	unsigned memory = 0;
+
+	return_val_if_untrue(frame, 0);
+
+	memory += ksize(frame);
+
+	if (frame->buffer)
+		memory += ksize(frame->buffer);
+
+	if (frame->segments) {
+		memory += ksize(frame->segments);
+		memory += frame->segment_count * sizeof(struct fscc_descriptor);
+	}
+	else if (frame->d1) {
+		memory += sizeof(*frame->d1);
+	}
+
+	return memory;
+}
+
+/*
+	The size kmalloc will really hand back for a request, which is what
+	ksize() later reports. Older kernels don't export the lookup so round up
+	to the next power of two, which never undershoots the slab size.
+*/
+static unsigned fscc_frame_kmalloc_size(unsigned size)
+{
+	if (size == 0)
+		return 0;
+
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(6, 1, 0)
+	return kmalloc_size_roundup(size);
+#else
+	return roundup_pow_of_two(size);
+#endif
+}
+
+/*
+	Memory a new frame holding length bytes will be charged once it is on a
+	list. Matches fscc_frame_get_memory_usage() so admission and accounting
+	agree.
+*/
+unsigned fscc_frame_estimate_memory_usage(unsigned length)
+{
+	return fscc_frame_kmalloc_size(sizeof(struct fscc_frame)) +
+	       fscc_frame_kmalloc_size(length) +
+	       sizeof(struct fscc_descriptor);
+}
+
+/* The data stays in user memory, only the per page bookkeeping is charged. */
+unsigned fscc_frame_estimate_zero_copy_usage(unsigned length)
+{
+	unsigned page_count = DIV_ROUND_UP(length, PAGE_SIZE) + 1;
+
+	return fscc_frame_kmalloc_size(sizeof(struct fscc_frame)) +
+	       fscc_frame_kmalloc_size(page_count *
+	                               sizeof(struct fscc_frame_segment)) +
+	       page_count * sizeof(struct fscc_descriptor);
+}
+
 unsigned fscc_frame_is_empty(struct fscc_frame *frame)
 {
 	return_val_if_untrue(frame, 0);
@@ -95,6 +165,40 @@ unsigned fscc_frame_is_empty(struct fscc_frame *frame)
 	return frame->data_length == 0;
 }
 
+/* Stamps the frame with the wall clock time (FSCC_TIMESTAMP_LEGACY). */
+void fscc_frame_set_timestamp(struct fscc_frame *frame)
+{
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(5, 0, 0)
+	struct timespec64 now;
+
+	ktime_get_real_ts64(&now);
+
+	frame->timestamp.tv_sec = now.tv_sec;
+#ifdef RELEASE_PREVIEW
+	frame->timestamp.tv_nsec = now.tv_nsec;
+#else
+	frame->timestamp.tv_usec = now.tv_nsec / NSEC_PER_USEC;
+#endif
+#else
+#ifdef RELEASE_PREVIEW
+	getnstimeofday(&frame->timestamp);
+#else
+	do_gettimeofday(&frame->timestamp);
+#endif
+#endif
+}
+
+/* Size of the timestamp appended to the frame, which depends on its clock. */
+unsigned fscc_frame_get_timestamp_length(struct fscc_frame *frame)
+{
+	return_val_if_untrue(frame, 0);
+
+	if (frame->timestamp_clock == FSCC_TIMESTAMP_LEGACY)
+		return sizeof(fscc_timestamp);
+
+	return sizeof(frame->timestamp_ns);
+}
+
 int fscc_frame_add_data(struct fscc_frame *frame, const char *data,
 						 unsigned length)
 {
@@ -161,6 +265,230 @@ int fscc_frame_add_data_from_user(struct fscc_frame *frame, const char *data,
 	return 1;
 }
 
+/*
+	Pins the user's buffer and builds a descriptor chain pointing straight at
+	it, one descriptor per page. The pages stay pinned until the frame is
+	deleted, so the caller has to wait for that before the buffer is reused.
+*/
+int fscc_frame_add_user_pages(struct fscc_frame *frame, const char *data,
+							  unsigned length)
+{
+	struct device *device = 0;
+	struct dma_pool *pool = 0;
+	struct page **pages = 0;
+	unsigned long start = 0;
+	unsigned offset = 0;
+	unsigned remaining = 0;
+	int page_count = 0;
+	int pinned = 0;
+	int i = 0;
+
+	return_val_if_untrue(frame, 0);
+	return_val_if_untrue(length > 0, 0);
+	return_val_if_untrue(frame->data_length == 0, 0);
+	return_val_if_untrue(frame->port->descriptor_pool, 0);
+
+#if LINUX_VERSION_CODE < KERNEL_VERSION(2, 6, 27)
+	return 0;
+#else
+	device = fscc_card_get_device(frame->port->card);
+	pool = frame->port->descriptor_pool;
+
+	start = (unsigned long)data;
+	offset = start & ~PAGE_MASK;
+	page_count = DIV_ROUND_UP(offset + length, PAGE_SIZE);
+
+	pages = kmalloc(page_count * sizeof(*pages), GFP_KERNEL);
+	frame->segments = kzalloc(page_count * sizeof(*frame->segments), GFP_KERNEL);
+
+	if (!pages || !frame->segments)
+		goto error;
+
+	/* The card only reads from these pages. They can stay pinned long after
+	   a non-blocking write returns. */
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(5, 6, 0)
+	pinned = pin_user_pages_fast(start & PAGE_MASK, page_count, FOLL_LONGTERM,
+	                             pages);
+#else
+	pinned = get_user_pages_fast(start & PAGE_MASK, page_count, 0, pages);
+#endif
+
+	if (pinned < page_count)
+		goto error;
+
+	remaining = length;
+
+	for (i = 0; i < page_count; i++) {
+		struct fscc_frame_segment *segment = &frame->segments[i];
+
+		segment->page = pages[i];
+		segment->offset = offset;
+		segment->length = min_t(unsigned, PAGE_SIZE - offset, remaining);
+
+		segment->data_handle = dma_map_page(device, segment->page,
+		                                    segment->offset, segment->length,
+		                                    DMA_TO_DEVICE);
+
+		if (dma_mapping_error(device, segment->data_handle)) {
+			dev_err(frame->port->device, "dma_mapping_error failed\n");
+			goto error;
+		}
+
+		segment->descriptor = dma_pool_alloc(pool, GFP_KERNEL,
+		                                     &segment->descriptor_handle);
+
+		if (!segment->descriptor) {
+			dma_unmap_page(device, segment->data_handle, segment->length,
+			               DMA_TO_DEVICE);
+			goto error;
+		}
+
+		frame->segment_count++;
+
+		remaining -= segment->length;
+		offset = 0;
+	}
+
+	for (i = 0; i < page_count; i++) {
+		struct fscc_frame_segment *segment = &frame->segments[i];
+		struct fscc_descriptor *descriptor = segment->descriptor;
+		unsigned last = (i == page_count - 1);
+
+		descriptor->control = segment->length;
+		descriptor->data_address = cpu_to_le32(segment->data_handle);
+		descriptor->data_count = segment->length;
+
+		if (last) {
+			descriptor->control |= DESC_FE_BIT | DESC_HI_BIT;
+			descriptor->next_descriptor = cpu_to_le32(frame->port->null_handle);
+		}
+		else {
+			descriptor->next_descriptor =
+				cpu_to_le32(frame->segments[i + 1].descriptor_handle);
+		}
+	}
+
+	/* Make sure the chain is complete before the card is pointed at it. */
+	wmb();
+
+	frame->d1 = frame->segments[0].descriptor;
+	frame->d1_handle = frame->segments[0].descriptor_handle;
+	frame->last_descriptor = frame->segments[page_count - 1].descriptor;
+	frame->data_length = length;
+	frame->dma_initialized = 1;
+
+	kfree(pages);
+
+	return 1;
+
+error:
+	/* Pages that were pinned but never made it into a segment. */
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(5, 6, 0)
+	if (pinned > (int)frame->segment_count)
+		unpin_user_pages(pages + frame->segment_count,
+		                 pinned - frame->segment_count);
+#else
+	for (i = frame->segment_count; i < pinned; i++)
+		put_page(pages[i]);
+#endif
+
+	fscc_frame_release_user_pages(frame);
+	kfree(pages);
+
+	return 0;
+#endif
+}
+
+void fscc_frame_release_user_pages(struct fscc_frame *frame)
+{
+	struct device *device = fscc_card_get_device(frame->port->card);
+	unsigned i = 0;
+
+	for (i = 0; i < frame->segment_count; i++) {
+		struct fscc_frame_segment *segment = &frame->segments[i];
+
+		dma_pool_free(frame->port->descriptor_pool, segment->descriptor,
+		              segment->descriptor_handle);
+		dma_unmap_page(device, segment->data_handle, segment->length,
+		               DMA_TO_DEVICE);
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(5, 6, 0)
+		unpin_user_page(segment->page);
+#else
+		put_page(segment->page);
+#endif
+	}
+
+	kfree(frame->segments);
+
+	frame->segments = 0;
+	frame->segment_count = 0;
+	frame->d1 = 0;
+	frame->last_descriptor = 0;
+}
+
+/* Gives the user pages back and marks the writer's buffer as free again. */
+static void fscc_frame_release_zero_copy(struct fscc_frame *frame)
+{
+	int done = 0;
+
+	fscc_frame_release_user_pages(frame);
+
+	/* Lets the writer waiting on this frame return. Purging can delete
+	   frames out of order, and on another CPU than the completion
+	   tasklet, so the sequence is only ever moved forward atomically. */
+	done = atomic_read(&frame->port->tx_zero_copy_done);
+
+	while ((int)(frame->zero_copy_sequence - done) > 0) {
+		int old_done = atomic_cmpxchg(&frame->port->tx_zero_copy_done,
+		                              done, frame->zero_copy_sequence);
+
+		if (old_done == done)
+			break;
+
+		done = old_done;
+	}
+
+	wake_up(&frame->port->output_queue);
+}
+
+/*
+	Moves a zero copy frame's data into a kernel buffer so it can go out
+	through the FIFO, and gives the user pages back. Returns 0 if the buffer
+	couldn't be allocated, the frame is left untouched then.
+*/
+int fscc_frame_copy_user_pages(struct fscc_frame *frame)
+{
+	char *buffer = 0;
+	unsigned copied = 0;
+	unsigned i = 0;
+
+	return_val_if_untrue(frame, 0);
+	return_val_if_untrue(frame->segments, 0);
+
+	buffer = kmalloc(frame->data_length, GFP_ATOMIC);
+
+	if (!buffer)
+		return 0;
+
+	for (i = 0; i < frame->segment_count; i++) {
+		struct fscc_frame_segment *segment = &frame->segments[i];
+		char *address = kmap_atomic(segment->page);
+
+		memcpy(buffer + copied, address + segment->offset, segment->length);
+		kunmap_atomic(address);
+
+		copied += segment->length;
+	}
+
+	fscc_frame_release_zero_copy(frame);
+
+	frame->buffer = buffer;
+	frame->buffer_size = frame->data_length;
+	frame->dma_initialized = 0;
+
+	return 1;
+}
+
 int fscc_frame_remove_data(struct fscc_frame *frame, char *destination,
 							unsigned length)
 {
@@ -255,55 +583,48 @@ int fscc_frame_setup_descriptors(struct fscc_frame *frame)
 	if (frame->fifo_initialized)
 		return 0;
 
-	frame->d1 = kmalloc(sizeof(*frame->d1), GFP_ATOMIC | GFP_DMA);
-
-	if (!frame->d1)
+	/* FIFO only ports have no descriptors to give out. */
+	if (!frame->port->descriptor_pool)
 		return 0;
 
-	memset(frame->d1, 0, sizeof(*frame->d1));
-
-	frame->d1_handle = pci_map_single(frame->port->card->pci_dev, frame->d1,
-	                                  sizeof(*frame->d1), DMA_TO_DEVICE);
-
-#if LINUX_VERSION_CODE >= KERNEL_VERSION(2, 6, 27)
-	if (dma_mapping_error(&frame->port->card->pci_dev->dev, frame->d1_handle)) {
-#else
-	if (dma_mapping_error(frame->d1_handle)) {
-#endif
-		dev_err(frame->port->device, "dma_mapping_error failed\n");
+	/* Already set up on an earlier attempt that had to wait for the card. */
+	if (frame->dma_initialized)
+		return 1;
 
-		kfree(frame->d1);
-		frame->d1 = 0;
+	frame->d1 = dma_pool_alloc(frame->port->descriptor_pool, GFP_ATOMIC,
+	                           &frame->d1_handle);
 
+	if (!frame->d1)
 		return 0;
-	}
-
 
-	frame->data_handle = pci_map_single(frame->port->card->pci_dev,
+	frame->data_handle = dma_map_single(fscc_card_get_device(frame->port->card),
 								        frame->buffer, frame->data_length,
 								        DMA_TO_DEVICE);
 
 #if LINUX_VERSION_CODE >= KERNEL_VERSION(2, 6, 27)
-	if (dma_mapping_error(&frame->port->card->pci_dev->dev, frame->data_handle)) {
+	if (dma_mapping_error(fscc_card_get_device(frame->port->card), frame->data_handle)) {
 #else
 	if (dma_mapping_error(frame->data_handle)) {
 #endif
 		dev_err(frame->port->device, "dma_mapping_error failed\n");
 
-		pci_unmap_single(frame->port->card->pci_dev, frame->d1_handle,
-						 sizeof(*frame->d1), DMA_TO_DEVICE);
-
-		kfree(frame->d1);
+		dma_pool_free(frame->port->descriptor_pool, frame->d1,
+		              frame->d1_handle);
 		frame->d1 = 0;
 
 		return 0;
 	}
 
-	frame->d1->control = 0xA0000000 | frame->data_length;
+	frame->d1->control = DESC_FE_BIT | DESC_HI_BIT | frame->data_length;
 	frame->d1->data_address = cpu_to_le32(frame->data_handle);
 	frame->d1->data_count = frame->data_length;
 	frame->d1->next_descriptor = cpu_to_le32(frame->port->null_handle);
 
+	frame->last_descriptor = frame->d1;
+
+	/* Make sure the descriptor is complete before the card is pointed at it. */
+	wmb();
+
 	frame->dma_initialized = 1;
 
 	return 1;
@@ -319,3 +640,17 @@ unsigned fscc_frame_is_fifo(struct fscc_frame *frame)
 	return (frame->fifo_initialized);
 }
 
+/* FIFO frames are done with as soon as they are copied to the card. */
+unsigned fscc_frame_is_sent(struct fscc_frame *frame)
+{
+	if (!fscc_frame_is_dma(frame))
+		return 1;
+
+	return (frame->last_descriptor->control == DESC_CSTOP_BIT);
+}
+
+unsigned fscc_frame_is_zero_copy(struct fscc_frame *frame)
+{
+	return (frame->segments != 0);
+}
+
@@ -22,28 +22,76 @@
 #define FSCC_FRAME_H
 
 #include <linux/list.h> /* struct list_head */
+#include <linux/time.h> /* struct timeval, struct timespec */
+#include <linux/version.h> /* LINUX_VERSION_CODE, KERNEL_VERSION */
 #include "descriptor.h" /* struct fscc_descriptor */
+#include "fscc.h" /* FSCC_DROP_* */
 
 
+/* Descriptor control bits. The card clears everything but CSTOP once a
+   descriptor has been sent. */
+#define DESC_FE_BIT 0x80000000
+#define DESC_CSTOP_BIT 0x40000000
+#define DESC_HI_BIT 0x20000000
+
+/* The kernel's own timeval and timespec went away in 5.6, the old user space
+   layout lives on under these names. */
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(5, 6, 0)
+#ifdef RELEASE_PREVIEW
+typedef struct __kernel_old_timespec fscc_timestamp;
+#else
+typedef struct __kernel_old_timeval fscc_timestamp;
+#endif
+#else
 #ifdef RELEASE_PREVIEW
 typedef struct timespec fscc_timestamp;
 #else
 typedef struct timeval fscc_timestamp;
 #endif
+#endif
 
 
+/* One pinned user page of a zero copy frame and the descriptor sending it. */
+struct fscc_frame_segment {
+	struct page *page;
+	unsigned offset;
+	unsigned length;
+	dma_addr_t data_handle;
+	struct fscc_descriptor *descriptor;
+	dma_addr_t descriptor_handle;
+};
+
 struct fscc_frame {
 	struct list_head list;
 	char *buffer;
 	unsigned data_length;
 	unsigned buffer_size;
-	unsigned number;
+	__u32 number; /* Per-port sequence number, RX and TX counted apart */
 	unsigned dma_initialized;
 	unsigned fifo_initialized;
-	fscc_timestamp timestamp;
+	unsigned memory_usage; /* Charged to the list the frame is queued in */
+	unsigned timestamp_clock; /* Clock the frame was stamped with */
+	fscc_timestamp timestamp; /* FSCC_TIMESTAMP_LEGACY */
+	__u64 timestamp_ns; /* Any other timestamp clock */
+
+	/* Latency checkpoints (ns). RX frames use the isr, tasklet and queued
+	   times, TX frames use the queued and handoff times. */
+	__u64 isr_time;
+	__u64 tasklet_time;
+	__u64 queued_time;
+	__u64 handoff_time;
 
 	struct fscc_descriptor *d1;
 	struct fscc_descriptor *d2;
+	struct fscc_descriptor *last_descriptor; /* Written back last by the card */
+
+	/* Zero copy frames send straight from the user's pages, buffer is unused. */
+	struct fscc_frame_segment *segments;
+	unsigned segment_count;
+	unsigned zero_copy_sequence;
+
+	unsigned tx_report; /* Report the frame's completion to the user */
+	__u64 cookie;
 
 	dma_addr_t data_handle;
 	dma_addr_t d1_handle;
@@ -57,6 +105,9 @@ void fscc_frame_delete(struct fscc_frame *frame);
 
 unsigned fscc_frame_get_length(struct fscc_frame *frame);
 unsigned fscc_frame_get_buffer_size(struct fscc_frame *frame);
+unsigned fscc_frame_get_memory_usage(struct fscc_frame *frame);
+unsigned fscc_frame_estimate_memory_usage(unsigned length);
+unsigned fscc_frame_estimate_zero_copy_usage(unsigned length);
 
 int fscc_frame_add_data(struct fscc_frame *frame, const char *data,
 						 unsigned length);
@@ -65,13 +116,21 @@ int fscc_frame_add_data_from_port(struct fscc_frame *frame, struct fscc_port *po
 								  unsigned length);
 int fscc_frame_add_data_from_user(struct fscc_frame *frame, const char *data,
 						 unsigned length);
+int fscc_frame_add_user_pages(struct fscc_frame *frame, const char *data,
+							  unsigned length);
+int fscc_frame_copy_user_pages(struct fscc_frame *frame);
 int fscc_frame_remove_data(struct fscc_frame *frame, char *destination,
 						   unsigned length);
+int fscc_frame_update_buffer_size(struct fscc_frame *frame, unsigned size);
 unsigned fscc_frame_is_empty(struct fscc_frame *frame);
+void fscc_frame_set_timestamp(struct fscc_frame *frame);
+unsigned fscc_frame_get_timestamp_length(struct fscc_frame *frame);
 
 void fscc_frame_clear(struct fscc_frame *frame);
 int fscc_frame_setup_descriptors(struct fscc_frame *frame);
 unsigned fscc_frame_is_dma(struct fscc_frame *frame);
 unsigned fscc_frame_is_fifo(struct fscc_frame *frame);
+unsigned fscc_frame_is_sent(struct fscc_frame *frame);
+unsigned fscc_frame_is_zero_copy(struct fscc_frame *frame);
 
 #endif
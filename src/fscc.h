@@ -26,6 +26,8 @@
 
 #define FSCC_REGISTERS_INIT(registers) memset(&registers, -1, sizeof(registers))
 #define FSCC_MEMORY_CAP_INIT(memory_cap) memset(&memory_cap, -1, sizeof(memory_cap))
+#define FSCC_WAKEUP_INIT(wakeup) memset(&wakeup, -1, sizeof(wakeup))
+#define FSCC_FIFOT_ADAPT_INIT(adapt) memset(&adapt, -1, sizeof(adapt))
 #define FSCC_UPDATE_VALUE -2
 
 #define FSCC_IOCTL_MAGIC 0x18
@@ -60,8 +62,53 @@
 #define FSCC_DISABLE_APPEND_TIMESTAMP _IO(FSCC_IOCTL_MAGIC, 20)
 #define FSCC_GET_APPEND_TIMESTAMP _IOR(FSCC_IOCTL_MAGIC, 21, unsigned *)
 
+#define FSCC_GET_STATS _IOR(FSCC_IOCTL_MAGIC, 22, struct fscc_stats *)
+
+#define FSCC_ENABLE_REPORT_OVERFLOW _IO(FSCC_IOCTL_MAGIC, 23)
+#define FSCC_DISABLE_REPORT_OVERFLOW _IO(FSCC_IOCTL_MAGIC, 24)
+#define FSCC_GET_REPORT_OVERFLOW _IOR(FSCC_IOCTL_MAGIC, 25, unsigned *)
+
+#define FSCC_SET_INPUT_CAP_POLICY _IOW(FSCC_IOCTL_MAGIC, 26, const unsigned)
+#define FSCC_GET_INPUT_CAP_POLICY _IOR(FSCC_IOCTL_MAGIC, 27, unsigned *)
+
+#define FSCC_SET_WAKEUP _IOW(FSCC_IOCTL_MAGIC, 28, struct fscc_wakeup *)
+#define FSCC_GET_WAKEUP _IOR(FSCC_IOCTL_MAGIC, 29, struct fscc_wakeup *)
+
+#define FSCC_SET_FLUSH_TIMEOUT _IOW(FSCC_IOCTL_MAGIC, 30, const unsigned)
+#define FSCC_GET_FLUSH_TIMEOUT _IOR(FSCC_IOCTL_MAGIC, 31, unsigned *)
+
+#define FSCC_SET_FIFOT_ADAPT _IOW(FSCC_IOCTL_MAGIC, 32, struct fscc_fifot_adapt *)
+#define FSCC_GET_FIFOT_ADAPT _IOR(FSCC_IOCTL_MAGIC, 33, struct fscc_fifot_adapt *)
+
+#define FSCC_SET_TX_ZERO_COPY _IOW(FSCC_IOCTL_MAGIC, 34, const unsigned)
+#define FSCC_GET_TX_ZERO_COPY _IOR(FSCC_IOCTL_MAGIC, 35, unsigned *)
+
+#define FSCC_SET_RX_FILTER _IOW(FSCC_IOCTL_MAGIC, 36, struct sock_fprog *)
+#define FSCC_CLEAR_RX_FILTER _IO(FSCC_IOCTL_MAGIC, 37)
+
+#define FSCC_SET_ADDRESS_FILTER _IOW(FSCC_IOCTL_MAGIC, 38, struct fscc_address_filter *)
+#define FSCC_GET_ADDRESS_FILTER _IOR(FSCC_IOCTL_MAGIC, 39, struct fscc_address_filter *)
+#define FSCC_CLEAR_ADDRESS_FILTER _IO(FSCC_IOCTL_MAGIC, 40)
+
+#define FSCC_ENABLE_APPEND_SEQUENCE _IO(FSCC_IOCTL_MAGIC, 41)
+#define FSCC_DISABLE_APPEND_SEQUENCE _IO(FSCC_IOCTL_MAGIC, 42)
+#define FSCC_GET_APPEND_SEQUENCE _IOR(FSCC_IOCTL_MAGIC, 43, unsigned *)
+
+#define FSCC_GET_RX_DROPS _IOR(FSCC_IOCTL_MAGIC, 44, struct fscc_rx_drops *)
+
+#define FSCC_SET_TIMESTAMP_CLOCK _IOW(FSCC_IOCTL_MAGIC, 45, const unsigned)
+#define FSCC_GET_TIMESTAMP_CLOCK _IOR(FSCC_IOCTL_MAGIC, 46, unsigned *)
+
+#define FSCC_ENABLE_TX_REPORTS _IO(FSCC_IOCTL_MAGIC, 47)
+#define FSCC_DISABLE_TX_REPORTS _IO(FSCC_IOCTL_MAGIC, 48)
+#define FSCC_GET_TX_REPORTS _IOR(FSCC_IOCTL_MAGIC, 49, unsigned *)
+#define FSCC_SET_TX_COOKIE _IOW(FSCC_IOCTL_MAGIC, 50, const __u64 *)
+#define FSCC_READ_TX_REPORTS _IOR(FSCC_IOCTL_MAGIC, 51, struct fscc_tx_reports *)
+
 
 enum transmit_modifiers { XF=0, XREP=1, TXT=2, TXEXT=4 };
+enum input_cap_policy { FSCC_CAP_DROP_NEWEST=0, FSCC_CAP_DROP_OLDEST=1, FSCC_CAP_BLOCK=2 };
+enum timestamp_clock { FSCC_TIMESTAMP_LEGACY=0, FSCC_TIMESTAMP_REALTIME=1, FSCC_TIMESTAMP_MONOTONIC=2, FSCC_TIMESTAMP_MONOTONIC_RAW=3, FSCC_TIMESTAMP_TAI=4 };
 typedef __s64 fscc_register;
 
 struct fscc_registers {
@@ -102,6 +149,101 @@ struct fscc_memory_cap {
 	int output;
 };
 
+struct fscc_wakeup {
+	int rx_frames; /* Wake readers once this many frames are queued */
+	int rx_bytes; /* ... or once this many bytes are queued */
+	int rx_timeout; /* ... or once data has waited this long (ms) */
+	int tx_bytes; /* Wake writers once this much output room is free */
+};
+
+struct fscc_fifot_adapt {
+	int enabled;
+	int rx_min; /* Bounds for the receive trigger level (bytes) */
+	int rx_max;
+	int tx_min; /* Bounds for the transmit trigger level (bytes) */
+	int tx_max;
+};
+
+/* Reasons an incoming frame never made it to the input queue. */
+#define FSCC_DROP_MEMORY_CAP 0
+#define FSCC_DROP_NO_MEMORY 1
+#define FSCC_DROP_OVERFLOW 2
+#define FSCC_DROP_EVICTED 3
+#define FSCC_DROP_RECLAIMED 4
+#define FSCC_DROP_FILTER 5
+#define FSCC_DROP_ADDRESS 6
+
+#define FSCC_MAX_RX_DROPS 16
+
+struct fscc_rx_drop {
+	__u32 first; /* Sequence number of the first frame lost */
+	__u32 count;
+	__u32 reason; /* FSCC_DROP_* */
+};
+
+struct fscc_rx_drops {
+	unsigned count; /* Ranges filled in, oldest first */
+	unsigned overwritten; /* Older ranges that didn't fit */
+	struct fscc_rx_drop ranges[FSCC_MAX_RX_DROPS];
+};
+
+/* How a frame written with transmit reports enabled left the card. */
+#define FSCC_TX_SENT 0
+#define FSCC_TX_UNDERRUN 1
+
+#define FSCC_MAX_TX_REPORTS 64
+
+struct fscc_tx_report {
+	__u64 cookie; /* From FSCC_SET_TX_COOKIE, one more for each write */
+	__u64 timestamp; /* Completion (ns) on the timestamp clock */
+	__u32 status; /* FSCC_TX_* */
+	__u32 reserved;
+};
+
+struct fscc_tx_reports {
+	unsigned count; /* Reports filled in, oldest first */
+	unsigned overwritten; /* Older reports that didn't fit */
+	struct fscc_tx_report reports[FSCC_MAX_TX_REPORTS];
+};
+
+#define FSCC_MAX_ADDRESSES 256
+
+struct fscc_address_filter {
+	unsigned width; /* Address length in bytes, 1 or 2 */
+	unsigned count;
+	unsigned exact; /* Read-only, RAR/RAMR match the set by themselves */
+	__u16 addresses[FSCC_MAX_ADDRESSES];
+};
+
+struct fscc_stats {
+	__u64 interrupts;
+
+	__u64 rfs;
+	__u64 rft;
+	__u64 rfe;
+	__u64 rfo;
+	__u64 rdo;
+	__u64 rfl;
+	__u64 tft;
+	__u64 alls;
+	__u64 tdu;
+
+	__u64 rx_frames;
+	__u64 rx_bytes;
+	__u64 rx_dropped; /* Frames lost before reaching the input queue */
+	__u64 rx_memory_cap_rejects;
+	__u64 rx_cap_dropped_newest;
+	__u64 rx_cap_dropped_oldest;
+	__u64 rx_cap_blocked;
+	__u64 rx_reclaimed; /* Frames dropped under system memory pressure */
+	__u64 rx_filtered; /* Frames dropped by the receive filter */
+	__u64 rx_address_rejects; /* Frames dropped by the address filter */
+
+	__u64 tx_frames;
+	__u64 tx_bytes;
+	__u64 tx_memory_cap_rejects;
+};
+
 extern struct list_head fscc_cards;
 
 #define COMMTECH_VENDOR_ID 0x18f7
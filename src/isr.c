@@ -24,9 +24,35 @@
 #include "utils.h" /* port_exists */
 #include "frame.h" /* struct fscc_frame */
 
+#define CREATE_TRACE_POINTS
+#include "trace.h" /* trace_fscc_* */
+
 #define TX_FIFO_SIZE 4096
 #define MAX_LEFTOVER_BYTES 3
 
+/*
+	Samples one of the timestamp clocks. Monotonic time was just read for the
+	latency histograms so it is reused.
+*/
+static __u64 timestamp_now(unsigned clock, __u64 monotonic)
+{
+	switch (clock) {
+	case FSCC_TIMESTAMP_REALTIME:
+		return ktime_to_ns(ktime_get_real());
+
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(3, 17, 0)
+	case FSCC_TIMESTAMP_MONOTONIC_RAW:
+		return ktime_get_raw_ns();
+
+	case FSCC_TIMESTAMP_TAI:
+		return ktime_get_clocktai_ns();
+#endif
+
+	default:
+		return monotonic;
+	}
+}
+
 #if LINUX_VERSION_CODE >= KERNEL_VERSION(2, 6, 19)
 irqreturn_t fscc_isr(int irq, void *potential_port)
 #else
@@ -47,25 +73,64 @@ irqreturn_t fscc_isr(int irq, void *potential_port, struct pt_regs *regs)
 	if (!isr_value)
 		return IRQ_NONE;
 
-	if (timer_pending(&port->timer))
-		del_timer(&port->timer);
+	trace_fscc_isr(port, isr_value);
+
+	fscc_stats_increment_interrupts(port->stats, isr_value);
+
+	if (isr_value & RFE) {
+		__u64 rx_time = fscc_latency_now();
+		unsigned clock = port->timestamp_clock;
+
+		/* The clock goes with the stamp so a frame is never labeled with a
+		   clock it wasn't stamped by. */
+		fscc_port_add_rx_stamp(port, rx_time,
+							   (clock != FSCC_TIMESTAMP_LEGACY) ?
+							   timestamp_now(clock, rx_time) : 0, clock);
+	}
+
+	if (isr_value & (ALLS | DT_FE | DT_HI)) {
+		port->tx_isr_time = fscc_latency_now();
+
+		if (port->tx_reports)
+			port->tx_isr_stamp = timestamp_now(port->timestamp_clock,
+											   port->tx_isr_time);
+	}
+
+	if (isr_value & TDU)
+		atomic_set(&port->tx_underrun, 1);
 
 	port->last_isr_value |= isr_value;
 	streaming = fscc_port_is_streaming(port);
 
+	/* The frames that were already complete in the FIFO when the overflow
+	   happened are still good, only the one after them is corrupt. */
+	if (isr_value & (RDO | RFO | RFL)) {
+		spin_lock(&port->pending_iframe_spinlock);
+
+		port->rx_overflow |= isr_value & (RDO | RFO);
+
+		if (isr_value & RDO)
+			port->rx_overflow_frames = fscc_port_get_RFCNT(port);
+
+		spin_unlock(&port->pending_iframe_spinlock);
+
+		atomic_inc(&port->rx_overflow_reports);
+		wake_up_interruptible(&port->input_queue);
+	}
+
 	if (streaming) {
 		if (isr_value & (RFT | RFS))
 			tasklet_schedule(&port->istream_tasklet);
 	}
 	else {
-		if (isr_value & (RFE | RFT | RFS))
+		if (isr_value & (RFE | RFT | RFS | RDO | RFO))
 			tasklet_schedule(&port->iframe_tasklet);
 	}
 
 	if (isr_value & TFT)
 		tasklet_schedule(&port->send_oframe_tasklet);
 
-	if (isr_value & ALLS)
+	if (isr_value & (ALLS | DT_FE | DT_HI))
 		tasklet_schedule(&port->clear_oframe_tasklet);
 
 #ifdef DEBUG
@@ -73,7 +138,7 @@ irqreturn_t fscc_isr(int irq, void *potential_port, struct pt_regs *regs)
 	fscc_port_increment_interrupt_counts(port, isr_value);
 #endif
 
-	fscc_port_reset_timer(port);
+	fscc_port_kick_flush_timer(port);
 
 	return IRQ_HANDLED;
 }
@@ -86,22 +151,79 @@ void iframe_worker(unsigned long data)
 	unsigned long board_flags = 0;
 	unsigned long frame_flags = 0;
 	unsigned long queued_flags = 0;
-	static int rejected_last_frame = 0;
 	unsigned current_memory = 0;
 	unsigned memory_cap = 0;
+	unsigned needed_memory = 0;
 	unsigned rfcnt = 0;
+	struct fscc_rx_stamp rx_stamp;
+	unsigned have_stamp = 0;
+	__u64 tasklet_time = 0;
 
 	port = (struct fscc_port *)data;
 
 	return_if_untrue(port);
 
+	tasklet_time = fscc_latency_now();
+
 	do {
 		current_memory = fscc_port_get_input_memory_usage(port);
-		memory_cap = fscc_port_get_input_memory_cap(port);
+		memory_cap = fscc_port_get_input_memory_limit(port);
 
 		spin_lock_irqsave(&port->board_rx_spinlock, board_flags);
 		spin_lock_irqsave(&port->pending_iframe_spinlock, frame_flags);
 
+		/* The frame counter can't be trusted after a frame overflow so the
+		   receiver has to be reset. That throws away the complete frames
+		   still in the FIFO too, so they are counted before it happens. The
+		   pending frame is the start of the first of them, or the only one
+		   lost if none have completed. */
+		if (port->rx_overflow & RFO) {
+			unsigned lost_frames = fscc_port_get_RFCNT(port);
+
+			dev_dbg(port->device, "resetting receiver (frame overflow)\n");
+
+			if (port->pending_iframe) {
+				trace_fscc_rx_drop(port, port->pending_iframe,
+								   fscc_frame_get_length(port->pending_iframe),
+								   FSCC_DROP_OVERFLOW);
+
+				fscc_frame_delete(port->pending_iframe);
+				port->pending_iframe = 0;
+
+				if (lost_frames)
+					lost_frames--;
+
+				fscc_stats_inc(port, rx_dropped);
+				fscc_port_add_rx_drop(port, port->rx_sequence++,
+									  FSCC_DROP_OVERFLOW);
+			}
+
+			for (; lost_frames > 0; lost_frames--) {
+				trace_fscc_rx_drop(port, 0, 0, FSCC_DROP_OVERFLOW);
+
+				fscc_stats_inc(port, rx_dropped);
+				fscc_port_add_rx_drop(port, port->rx_sequence++,
+									  FSCC_DROP_OVERFLOW);
+			}
+
+			fscc_port_execute_RRES(port);
+			fscc_port_clear_rx_stamps(port);
+
+			port->rx_overflow = 0;
+			port->rx_discard = 0;
+
+			spin_unlock_irqrestore(&port->pending_iframe_spinlock, frame_flags);
+			spin_unlock_irqrestore(&port->board_rx_spinlock, board_flags);
+			return;
+		}
+
+		if (port->rx_overflow & RDO) {
+			port->rx_overflow &= ~RDO;
+			port->rx_discard = 1;
+			port->rx_discard_skip = port->rx_overflow_frames;
+			port->rx_discard_reason = FSCC_DROP_OVERFLOW;
+		}
+
 		rfcnt = fscc_port_get_RFCNT(port);
 		finished_frame = (rfcnt > 0) ? 1 : 0;
 
@@ -143,33 +265,140 @@ void iframe_worker(unsigned long data)
 			return;
 		}
 
+		/* Every completed frame uses up the oldest RFE stamp, including the
+		   ones dropped below, so later frames stay matched to their own. */
+		have_stamp = (finished_frame) ?
+					 fscc_port_take_rx_stamp(port, &rx_stamp, rfcnt) : 0;
+
+		/* The first chunk of a frame also pays for the frame itself. */
+		if (port->pending_iframe)
+			needed_memory = receive_length;
+		else
+			needed_memory = fscc_frame_estimate_memory_usage(receive_length);
+
+		/* Make room by throwing away the oldest frames if that is the
+		   policy. */
+		if (current_memory + needed_memory > memory_cap &&
+			port->input_cap_policy == FSCC_CAP_DROP_OLDEST) {
+			current_memory -= fscc_port_evict_iframes(port,
+						current_memory + needed_memory - memory_cap,
+						FSCC_DROP_EVICTED);
+		}
+
 		/* Make sure we don't go over the user's memory constraint. */
-		if (current_memory + receive_length > memory_cap) {
-			if (rejected_last_frame == 0) {
+		if (current_memory + needed_memory > memory_cap) {
+			if (port->rejected_last_frame == 0) {
 				dev_warn(port->device,
 						 "Rejecting frames (memory constraint)\n");
-				rejected_last_frame = 1; /* Track that we dropped a frame so we
-								don't have to warn the user again. */
+				port->rejected_last_frame = 1; /* Track that we dropped a frame
+								so we don't have to warn the user again. */
 			}
 
+			fscc_stats_inc(port, rx_memory_cap_rejects);
+
+			/* Leave the data in the FIFO and let the hardware apply flow
+			   control. Reading frames will restart this tasklet. */
+			if (port->input_cap_policy == FSCC_CAP_BLOCK) {
+				if (!port->rx_blocked)
+					fscc_stats_inc(port, rx_cap_blocked);
+
+				port->rx_blocked = 1;
+
+				spin_unlock_irqrestore(&port->pending_iframe_spinlock, frame_flags);
+				spin_unlock_irqrestore(&port->board_rx_spinlock, board_flags);
+				return;
+			}
+
+			trace_fscc_rx_drop(port, port->pending_iframe, receive_length,
+							   FSCC_DROP_MEMORY_CAP);
+
 			if (port->pending_iframe) {
 				fscc_frame_delete(port->pending_iframe);
 				port->pending_iframe = 0;
 			}
 
+			/* The data still has to leave the FIFO or we stop receiving. */
+			fscc_port_discard_rx_data(port, receive_length);
+
+			if (!finished_frame) {
+				/* The rest of this frame is thrown away when it completes. */
+				if (!port->rx_discard) {
+					port->rx_discard = 1;
+					port->rx_discard_skip = 0;
+					port->rx_discard_reason = FSCC_DROP_MEMORY_CAP;
+				}
+
+				spin_unlock_irqrestore(&port->pending_iframe_spinlock, frame_flags);
+				spin_unlock_irqrestore(&port->board_rx_spinlock, board_flags);
+				return;
+			}
+
+			if (port->rx_discard) {
+				if (port->rx_discard_skip)
+					port->rx_discard_skip--;
+				else
+					port->rx_discard = 0;
+			}
+
+			fscc_stats_inc(port, rx_dropped);
+			fscc_stats_inc(port, rx_cap_dropped_newest);
+			fscc_port_add_rx_drop(port, port->rx_sequence++,
+								  FSCC_DROP_MEMORY_CAP);
+
 			spin_unlock_irqrestore(&port->pending_iframe_spinlock, frame_flags);
 			spin_unlock_irqrestore(&port->board_rx_spinlock, board_flags);
-			return;
+			continue;
 		}
 
 		if (!port->pending_iframe) {
 			port->pending_iframe = fscc_frame_new(port);
 
+			/* Leaving the data in the FIFO would have the next pass count
+			   the same frame again, so it is thrown away like a frame over
+			   the memory cap and only counted once it completes. */
 			if (!port->pending_iframe) {
+				unsigned reason = FSCC_DROP_NO_MEMORY;
+
+				fscc_port_discard_rx_data(port, receive_length);
+
+				if (!finished_frame) {
+					if (!port->rx_discard) {
+						port->rx_discard = 1;
+						port->rx_discard_skip = 0;
+						port->rx_discard_reason = FSCC_DROP_NO_MEMORY;
+					}
+
+					spin_unlock_irqrestore(&port->pending_iframe_spinlock, frame_flags);
+					spin_unlock_irqrestore(&port->board_rx_spinlock, board_flags);
+					return;
+				}
+
+				if (port->rx_discard) {
+					if (port->rx_discard_skip) {
+						port->rx_discard_skip--;
+					}
+					else {
+						port->rx_discard = 0;
+						reason = port->rx_discard_reason;
+					}
+				}
+
+				fscc_stats_inc(port, rx_dropped);
+
+				if (reason == FSCC_DROP_MEMORY_CAP)
+					fscc_stats_inc(port, rx_cap_dropped_newest);
+
+				trace_fscc_rx_drop(port, 0, receive_length, reason);
+				fscc_port_add_rx_drop(port, port->rx_sequence++, reason);
+
 				spin_unlock_irqrestore(&port->pending_iframe_spinlock, frame_flags);
 				spin_unlock_irqrestore(&port->board_rx_spinlock, board_flags);
-				return;
+				continue;
 			}
+
+			/* The number is only used up once the frame completes, frames
+			   the user filtered out don't leave a gap. */
+			port->pending_iframe->number = port->rx_sequence;
 		}
 
 		fscc_frame_add_data_from_port(port->pending_iframe, port, receive_length);
@@ -185,10 +414,8 @@ void iframe_worker(unsigned long data)
 		}
 	#endif
 
-		dev_dbg(port->device, "F#%i <= %i byte%s (%sfinished)\n",
-				port->pending_iframe->number, receive_length,
-				(receive_length == 1) ? "" : "s",
-				(finished_frame) ? "" : "un");
+		trace_fscc_rx_chunk(port, port->pending_iframe, receive_length,
+							finished_frame);
 
 		if (!finished_frame) {
 			spin_unlock_irqrestore(&port->pending_iframe_spinlock, frame_flags);
@@ -196,26 +423,106 @@ void iframe_worker(unsigned long data)
 			return;
 		}
 
+		/* Drop the frame that was being received during a data overflow or
+		   whose beginning didn't fit under the memory cap. */
+		if (port->rx_discard) {
+			if (port->rx_discard_skip) {
+				port->rx_discard_skip--;
+			}
+			else {
+				port->rx_discard = 0;
+
+				fscc_stats_inc(port, rx_dropped);
+
+				if (port->rx_discard_reason == FSCC_DROP_MEMORY_CAP)
+					fscc_stats_inc(port, rx_cap_dropped_newest);
+
+				trace_fscc_rx_drop(port, port->pending_iframe,
+								   fscc_frame_get_length(port->pending_iframe),
+								   port->rx_discard_reason);
+				fscc_port_add_rx_drop(port, port->rx_sequence++,
+									  port->rx_discard_reason);
+
+				fscc_frame_delete(port->pending_iframe);
+				port->pending_iframe = 0;
+			}
+		}
+
+		/* Frames the user doesn't want never reach the queue or count
+		   against the memory cap. */
+		if (port->pending_iframe && port->address_set &&
+			!fscc_address_set_match(port->address_set, port->pending_iframe)) {
+			fscc_stats_inc(port, rx_address_rejects);
+
+			trace_fscc_rx_drop(port, port->pending_iframe,
+							   fscc_frame_get_length(port->pending_iframe),
+							   FSCC_DROP_ADDRESS);
+
+			fscc_frame_delete(port->pending_iframe);
+			port->pending_iframe = 0;
+		}
+
+		if (port->pending_iframe && port->rx_filter &&
+			!fscc_filter_frame(port->rx_filter, port->pending_iframe)) {
+			fscc_stats_inc(port, rx_filtered);
+
+			trace_fscc_rx_drop(port, port->pending_iframe,
+							   fscc_frame_get_length(port->pending_iframe),
+							   FSCC_DROP_FILTER);
+
+			fscc_frame_delete(port->pending_iframe);
+			port->pending_iframe = 0;
+		}
+
 		if (port->pending_iframe) {
-#ifdef RELEASE_PREVIEW
-			getnstimeofday(&port->pending_iframe->timestamp);
-#else
-			do_gettimeofday(&port->pending_iframe->timestamp);
-#endif
+			port->rx_sequence++;
+
+			trace_fscc_rx_frame(port, port->pending_iframe);
+
+			fscc_stats_inc(port, rx_frames);
+			fscc_stats_add(port, rx_bytes,
+						   fscc_frame_get_length(port->pending_iframe));
+
+			/* Frames completed without an RFE of their own (RFE masked, or
+			   several frames per interrupt) are stamped here instead. */
+			if (have_stamp) {
+				port->pending_iframe->timestamp_clock = rx_stamp.clock;
+				port->pending_iframe->timestamp_ns = rx_stamp.stamp;
+			} else {
+				port->pending_iframe->timestamp_clock = port->timestamp_clock;
+				port->pending_iframe->timestamp_ns =
+					timestamp_now(port->timestamp_clock, tasklet_time);
+			}
+
+			if (port->pending_iframe->timestamp_clock == FSCC_TIMESTAMP_LEGACY)
+				fscc_frame_set_timestamp(port->pending_iframe);
+
+			/* Left at 0 without a stamp of its own, which keeps the frame
+			   out of the ISR based latency histograms. */
+			port->pending_iframe->isr_time = (have_stamp) ? rx_stamp.time : 0;
+			port->pending_iframe->tasklet_time = tasklet_time;
+			port->pending_iframe->queued_time = fscc_latency_now();
+
+			fscc_latency_record(port->latency, FSCC_LATENCY_RX_ISR_TO_TASKLET,
+								port->pending_iframe->isr_time, tasklet_time);
+			fscc_latency_record(port->latency, FSCC_LATENCY_RX_TASKLET_TO_QUEUE,
+								tasklet_time, port->pending_iframe->queued_time);
+
 			spin_lock_irqsave(&port->queued_iframes_spinlock, queued_flags);
 			fscc_flist_add_frame(&port->queued_iframes, port->pending_iframe);
 			spin_unlock_irqrestore(&port->queued_iframes_spinlock, queued_flags);
 		}
 
-		rejected_last_frame = 0; /* Track that we received a frame to reset the
-									memory constraint warning print message. */
+		port->rejected_last_frame = 0; /* Track that we received a frame to
+							reset the memory constraint warning print message. */
 
 		port->pending_iframe = 0;
 
 		spin_unlock_irqrestore(&port->pending_iframe_spinlock, frame_flags);
 	    spin_unlock_irqrestore(&port->board_rx_spinlock, board_flags);
 
-		wake_up_interruptible(&port->input_queue);
+		fscc_port_wake_readers(port);
+		fscc_netdev_rx_schedule(port);
 	}
 	while (receive_length);
 }
@@ -229,7 +536,7 @@ void istream_worker(unsigned long data)
 	unsigned long stream_flags = 0;
 	unsigned current_memory = 0;
 	unsigned memory_cap = 0;
-	static int rejected_last_stream = 0;
+	unsigned rejected = 0;
 	unsigned status;
 
 	port = (struct fscc_port *)data;
@@ -237,19 +544,7 @@ void istream_worker(unsigned long data)
 	return_if_untrue(port);
 
 	current_memory = fscc_port_get_input_memory_usage(port);
-	memory_cap = fscc_port_get_input_memory_cap(port);
-
-	/* Leave the interrupt handler if we are at our memory cap. */
-	if (current_memory >= memory_cap) {
-		if (rejected_last_stream == 0) {
-			dev_warn(port->device, "Rejecting stream (memory constraint)\n");
-
-			rejected_last_stream = 1; /* Track that we dropped stream data so we
-									 don't have to warn the user again. */
-		}
-
-		return;
-	}
+	memory_cap = fscc_port_get_input_memory_limit(port);
 
 	spin_lock_irqsave(&port->board_rx_spinlock, board_flags);
 
@@ -266,73 +561,171 @@ void istream_worker(unsigned long data)
 		return;
 	}
 
+	if (receive_length + current_memory > memory_cap) {
+		rejected = 1;
+
+		if (port->rejected_last_stream == 0) {
+			dev_warn(port->device, "Rejecting stream (memory constraint)\n");
+
+			port->rejected_last_stream = 1; /* Track that we dropped stream
+							data so we don't have to warn the user again. */
+		}
+
+		fscc_stats_inc(port, rx_memory_cap_rejects);
+
+		/* Make room by throwing away the oldest stream data. */
+		if (port->input_cap_policy == FSCC_CAP_DROP_OLDEST) {
+			unsigned trim_length = 0;
+
+			spin_lock_irqsave(&port->istream_spinlock, stream_flags);
+			trim_length = min(receive_length + current_memory - memory_cap,
+							  fscc_frame_get_length(port->istream));
+			fscc_frame_remove_data(port->istream, NULL, trim_length);
+			fscc_port_charge_istream(port);
+			spin_unlock_irqrestore(&port->istream_spinlock, stream_flags);
+
+			if (trim_length)
+				fscc_stats_inc(port, rx_cap_dropped_oldest);
+
+			current_memory -= trim_length;
+		}
+	}
+
 	/* Trim the amount to read if there isn't enough memory space to read all
-	   of it. */
-	if (receive_length + current_memory > memory_cap)
-		receive_length = memory_cap - current_memory;
-
-	spin_lock_irqsave(&port->istream_spinlock, stream_flags);
-	status = fscc_frame_add_data_from_port(port->istream, port, receive_length);
-	spin_unlock_irqrestore(&port->istream_spinlock, stream_flags);
-	if (status == 0) {
-		dev_err(port->device, "Error adding stream data");
-		spin_unlock_irqrestore(&port->board_rx_spinlock, board_flags);
-		return;
+	   of it. A multiple of 4 is kept so no data is lost from the FIFO. Stream
+	   data has no frame boundary to drop up to, so under every policy the
+	   rest stays in the FIFO and is read once there is room for it. */
+	if (receive_length + current_memory > memory_cap) {
+		int available = (current_memory < memory_cap) ?
+						memory_cap - current_memory : 0;
+
+		available -= available % 4;
+		receive_length = available;
+
+		if (port->input_cap_policy == FSCC_CAP_BLOCK) {
+			if (!port->rx_blocked)
+				fscc_stats_inc(port, rx_cap_blocked);
+
+			port->rx_blocked = 1;
+		}
+	}
+
+	if (receive_length > 0) {
+		spin_lock_irqsave(&port->istream_spinlock, stream_flags);
+		status = fscc_frame_add_data_from_port(port->istream, port, receive_length);
+		fscc_port_charge_istream(port);
+		spin_unlock_irqrestore(&port->istream_spinlock, stream_flags);
+		if (status == 0) {
+			dev_err(port->device, "Error adding stream data");
+			spin_unlock_irqrestore(&port->board_rx_spinlock, board_flags);
+			return;
+		}
 	}
 
 	spin_unlock_irqrestore(&port->board_rx_spinlock, board_flags);
 
-	rejected_last_stream = 0; /* Track that we received stream data to reset
-								 the memory constraint warning print message.
-							  */
+	if (receive_length <= 0)
+		return;
 
-	dev_dbg(port->device, "Stream <= %i byte%s\n", receive_length,
-			(receive_length == 1) ? "" : "s");
+	fscc_stats_add(port, rx_bytes, receive_length);
 
-	wake_up_interruptible(&port->input_queue);
+	if (!rejected)
+		port->rejected_last_stream = 0; /* Track that we received stream data
+							to reset the memory constraint warning print message. */
+
+	trace_fscc_rx_chunk(port, 0, receive_length, 0);
+
+	fscc_port_wake_readers(port);
 }
 
+/*
+	Reaps every finished frame at the front of sent_oframes in one pass. DMA
+	frames finish in order, so the walk stops at the first descriptor the card
+	hasn't completed yet.
+*/
 void clear_oframe_worker(unsigned long data)
 {
 	struct fscc_port *port = 0;
 	struct fscc_frame *frame = 0;
-	unsigned remove = 0;
+	struct fscc_frame *next = 0;
 	unsigned long sent_flags = 0;
+	unsigned removed = 0;
+	unsigned status = FSCC_TX_SENT;
+	__u64 complete_time = 0;
+	__u64 complete_stamp = 0;
+	LIST_HEAD(done);
 
 	port = (struct fscc_port *)data;
 
+	return_if_untrue(port);
+
+	complete_time = port->tx_isr_time;
+	complete_stamp = port->tx_isr_stamp;
+
 	spin_lock_irqsave(&port->sent_oframes_spinlock, sent_flags);
 
-	frame = fscc_flist_peek_front(&port->sent_oframes);
+	while ((frame = fscc_flist_peek_front(&port->sent_oframes))) {
+		if (!fscc_frame_is_sent(frame))
+			break;
 
-	if (!frame) {
-		spin_unlock_irqrestore(&port->sent_oframes_spinlock, sent_flags);
-		return;
+		fscc_flist_remove_frame(&port->sent_oframes);
+		list_add_tail(&frame->list, &done);
 	}
 
-	if (fscc_frame_is_dma(frame)) {
-		if (frame->d1->control == 0x40000000)
-			remove = 1;
-	}
-	else {
-		remove = 1;
-	}
+	spin_unlock_irqrestore(&port->sent_oframes_spinlock, sent_flags);
 
-	if (remove) {
-		fscc_flist_remove_frame(&port->sent_oframes);
-		fscc_frame_delete(frame);
+	/* The card doesn't say which frame underran, so every frame cleared
+	   along with the TDU is reported as possibly cut short. */
+	if (!list_empty(&done) && atomic_xchg(&port->tx_underrun, 0))
+		status = FSCC_TX_UNDERRUN;
+
+	list_for_each_entry_safe(frame, next, &done, list) {
+		__u64 frame_time = complete_time;
+		__u64 frame_stamp = complete_stamp;
+
+		/* Fall back to now if the interrupt predates this frame's handoff. */
+		if (frame_time < frame->handoff_time) {
+			frame_time = fscc_latency_now();
+			frame_stamp = timestamp_now(port->timestamp_clock, frame_time);
+		}
+
+		if (frame->tx_report)
+			fscc_port_add_tx_report(port, frame->cookie, frame_stamp, status);
+
+		fscc_latency_record(port->latency, FSCC_LATENCY_TX_HANDOFF_TO_COMPLETE,
+							frame->handoff_time, frame_time);
+		fscc_latency_record(port->latency, FSCC_LATENCY_TX_TOTAL,
+							frame->queued_time, frame_time);
+
+		trace_fscc_tx_complete(port, frame);
 
-		if (!fscc_flist_is_empty(&port->sent_oframes))
-		    tasklet_schedule(&port->clear_oframe_tasklet);
+		list_del(&frame->list);
+		fscc_frame_delete(frame);
+		removed++;
 	}
 
-	spin_unlock_irqrestore(&port->sent_oframes_spinlock, sent_flags);
+	if (removed) {
+		fscc_port_wake_writers(port);
+		fscc_budget_release(port);
+
+		/* Pollers waiting for transmit reports. */
+		if (port->tx_reports)
+			wake_up_interruptible(&port->output_queue);
+	}
 }
 
+/*
+	Fills the transmit FIFO with as many queued frames as fit. Each frame is
+	handed off with its own byte count, so on FIFO only cards several small
+	frames go out per TFT instead of one. DMA capable ports and transmit repeat
+	still get one frame per pass.
+*/
 void oframe_worker(unsigned long data)
 {
 	struct fscc_port *port = 0;
-	int result;
+	int result = 0;
+	unsigned frames_sent = 0;
+	unsigned pack_frames = 0;
 
 	unsigned long board_flags = 0;
 	unsigned long frame_flags = 0;
@@ -343,49 +736,95 @@ void oframe_worker(unsigned long data)
 
 	return_if_untrue(port);
 
+	pack_frames = !fscc_port_has_dma(port) && !(port->tx_modifiers & XREP);
+
 	spin_lock_irqsave(&port->board_tx_spinlock, board_flags);
 	spin_lock_irqsave(&port->pending_oframe_spinlock, frame_flags);
 
-	/* Check if exists and if so, grabs the frame to transmit. */
-	if (!port->pending_oframe) {
-		spin_lock_irqsave(&port->queued_oframes_spinlock, queued_flags);
-		port->pending_oframe = fscc_flist_remove_frame(&port->queued_oframes);
-		spin_unlock_irqrestore(&port->queued_oframes_spinlock, queued_flags);
-
-		/* No frames in queue to transmit */
+	do {
+		/* Check if exists and if so, grabs the frame to transmit. */
 		if (!port->pending_oframe) {
-			spin_unlock_irqrestore(&port->pending_oframe_spinlock, frame_flags);
-			spin_unlock_irqrestore(&port->board_tx_spinlock, board_flags);
-			return;
+			spin_lock_irqsave(&port->queued_oframes_spinlock, queued_flags);
+			port->pending_oframe = fscc_flist_remove_frame(&port->queued_oframes);
+			spin_unlock_irqrestore(&port->queued_oframes_spinlock, queued_flags);
+
+			/* No frames in queue to transmit */
+			if (!port->pending_oframe)
+				break;
 		}
-	}
 
-	result = fscc_port_transmit_frame(port, port->pending_oframe);
+		result = fscc_port_transmit_frame(port, port->pending_oframe);
+
+		if (result != 2)
+			break;
 
-	if (result == 2) {
 		spin_lock_irqsave(&port->sent_oframes_spinlock, sent_flags);
 		fscc_flist_add_frame(&port->sent_oframes, port->pending_oframe);
 		spin_unlock_irqrestore(&port->sent_oframes_spinlock, sent_flags);
 
 		port->pending_oframe = 0;
-	}
+		frames_sent++;
+	} while (pack_frames);
 
 	spin_unlock_irqrestore(&port->pending_oframe_spinlock, frame_flags);
 	spin_unlock_irqrestore(&port->board_tx_spinlock, board_flags);
 
-	if (result == 2)
-		wake_up_interruptible(&port->output_queue);
+	if (frames_sent)
+		fscc_port_wake_writers(port);
 }
 
-void timer_handler(unsigned long data)
+/* Queued data has waited rx_timeout without reaching the wake thresholds. */
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(4, 15, 0)
+void rx_wake_timer_handler(struct timer_list *timer)
+{
+	struct fscc_port *port = from_timer(port, timer, rx_wake_timer);
+#else
+void rx_wake_timer_handler(unsigned long data)
 {
 	struct fscc_port *port = (struct fscc_port *)data;
-	unsigned streaming = 0;
+#endif
 
-	streaming = fscc_port_is_streaming(port);
+	port->rx_wake_expired = 1;
+
+	wake_up_interruptible(&port->input_queue);
+}
+
+/*
+	Picks up data sitting below the FIFO trigger level once the port has been
+	quiet for flush_timeout microseconds. Interrupts only move the deadline
+	forward, the timer pushes itself back until it is reached.
+*/
+enum hrtimer_restart flush_timer_handler(struct hrtimer *timer)
+{
+	struct fscc_port *port = 0;
+	__u64 last_activity = 0;
+	__u64 deadline = 0;
+
+	port = container_of(timer, struct fscc_port, flush_timer);
+
+	last_activity = port->last_activity;
+	deadline = last_activity + (__u64)port->flush_timeout * NSEC_PER_USEC;
 
-	if (streaming)
+	if (fscc_latency_now() < deadline) {
+		hrtimer_set_expires(timer, ns_to_ktime(deadline));
+		return HRTIMER_RESTART;
+	}
+
+	if (fscc_port_is_streaming(port))
 		tasklet_schedule(&port->istream_tasklet);
 	else
 		tasklet_schedule(&port->iframe_tasklet);
+
+	clear_bit(0, &port->flush_armed);
+	smp_mb();
+
+	/* An interrupt came in while we were deciding to stop. */
+	if (port->last_activity != last_activity &&
+		!test_and_set_bit(0, &port->flush_armed)) {
+		hrtimer_forward_now(timer, ns_to_ktime((__u64)port->flush_timeout *
+											   NSEC_PER_USEC));
+		return HRTIMER_RESTART;
+	}
+
+	return HRTIMER_NORESTART;
 }
@@ -23,6 +23,7 @@
 
 #include <linux/version.h> /* LINUX_VERSION_CODE, KERNEL_VERSION */
 #include <linux/interrupt.h> /* struct pt_regs */
+#include <linux/hrtimer.h> /* struct hrtimer */
 
 #if LINUX_VERSION_CODE >= KERNEL_VERSION(2, 6, 19)
 irqreturn_t fscc_isr(int irq, void *dev_id);
@@ -35,6 +36,11 @@ void clear_oframe_worker(unsigned long data);
 void iframe_worker(unsigned long data);
 void istream_worker(unsigned long data);
 
-void timer_handler(unsigned long data);
+enum hrtimer_restart flush_timer_handler(struct hrtimer *timer);
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(4, 15, 0)
+void rx_wake_timer_handler(struct timer_list *timer);
+#else
+void rx_wake_timer_handler(unsigned long data);
+#endif
 
 #endif
@@ -0,0 +1,152 @@
+/*
+	Copyright (C) 2014 Commtech, Inc.
+
+	This file is part of fscc-linux.
+
+	fscc-linux is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	fscc-linux is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with fscc-linux.	If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include <linux/debugfs.h> /* debugfs_* */
+#include <linux/seq_file.h> /* seq_*, single_open */
+#include <linux/bitops.h> /* fls64 */
+
+#include "latency.h"
+#include "port.h" /* struct fscc_port */
+#include "config.h" /* DEVICE_NAME */
+#include "utils.h" /* return_{val_}if_untrue */
+
+#ifdef DEBUG
+#include "microbench.h"
+#endif
+
+static struct dentry *fscc_debugfs_root = 0;
+
+static const char *stage_names[FSCC_LATENCY_STAGES] = {
+	"rx_isr_to_tasklet",
+	"rx_tasklet_to_queue",
+	"rx_queue_to_user",
+	"rx_total",
+	"tx_write_to_handoff",
+	"tx_handoff_to_complete",
+	"tx_total",
+};
+
+struct fscc_latency __percpu *fscc_latency_new(void)
+{
+	return alloc_percpu(struct fscc_latency);
+}
+
+void fscc_latency_delete(struct fscc_latency __percpu *latency)
+{
+	return_if_untrue(latency);
+
+	free_percpu(latency);
+}
+
+/* A start value of 0 means the stage wasn't timestamped so it is skipped. */
+void fscc_latency_record(struct fscc_latency __percpu *latency,
+						 unsigned stage, __u64 start, __u64 end)
+{
+	unsigned bucket = 0;
+
+	if (!start || end < start)
+		return;
+
+	bucket = min(fls64(end - start), FSCC_LATENCY_BUCKETS - 1);
+
+	this_cpu_inc(latency->buckets[stage][bucket]);
+}
+
+static int fscc_latency_show(struct seq_file *m, void *v)
+{
+	struct fscc_port *port = m->private;
+	unsigned stage = 0;
+	unsigned bucket = 0;
+	unsigned cpu = 0;
+
+	for (stage = 0; stage < FSCC_LATENCY_STAGES; stage++) {
+		seq_printf(m, "%s\n", stage_names[stage]);
+
+		for (bucket = 0; bucket < FSCC_LATENCY_BUCKETS; bucket++) {
+			__u64 count = 0;
+
+			for_each_possible_cpu(cpu)
+				count += per_cpu_ptr(port->latency, cpu)->buckets[stage][bucket];
+
+			if (count == 0)
+				continue;
+
+			if (bucket == FSCC_LATENCY_BUCKETS - 1)
+				seq_printf(m, "  >= %llu ns: %llu\n",
+						   1ULL << (bucket - 1), count);
+			else
+				seq_printf(m, "  < %llu ns: %llu\n", 1ULL << bucket, count);
+		}
+	}
+
+	return 0;
+}
+
+static int fscc_latency_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, fscc_latency_show, inode->i_private);
+}
+
+static const struct file_operations fscc_latency_fops = {
+	.owner = THIS_MODULE,
+	.open = fscc_latency_open,
+	.read = seq_read,
+	.llseek = seq_lseek,
+	.release = single_release,
+};
+
+void fscc_latency_debugfs_init(void)
+{
+	fscc_debugfs_root = debugfs_create_dir(DEVICE_NAME, NULL);
+
+#ifdef DEBUG
+	fscc_microbench_debugfs_create(fscc_debugfs_root);
+#endif
+}
+
+void fscc_latency_debugfs_exit(void)
+{
+	debugfs_remove_recursive(fscc_debugfs_root);
+	fscc_debugfs_root = 0;
+}
+
+void fscc_latency_debugfs_create(struct fscc_port *port)
+{
+	return_if_untrue(port);
+
+	if (IS_ERR_OR_NULL(fscc_debugfs_root))
+		return;
+
+	port->debugfs_dir = debugfs_create_dir(port->name, fscc_debugfs_root);
+
+	if (IS_ERR_OR_NULL(port->debugfs_dir))
+		return;
+
+	debugfs_create_file("latency", SYSFS_READ_ONLY_MODE, port->debugfs_dir,
+						port, &fscc_latency_fops);
+}
+
+void fscc_latency_debugfs_remove(struct fscc_port *port)
+{
+	return_if_untrue(port);
+
+	debugfs_remove_recursive(port->debugfs_dir);
+	port->debugfs_dir = 0;
+}
@@ -0,0 +1,63 @@
+/*
+	Copyright (C) 2014 Commtech, Inc.
+
+	This file is part of fscc-linux.
+
+	fscc-linux is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	fscc-linux is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with fscc-linux.	If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef FSCC_LATENCY_H
+#define FSCC_LATENCY_H
+
+#include <linux/percpu.h> /* alloc_percpu, this_cpu_* */
+#include <linux/ktime.h> /* ktime_get */
+
+/* Bucket n counts deltas in [2^(n-1), 2^n) nanoseconds, the last bucket
+   catches everything larger. */
+#define FSCC_LATENCY_BUCKETS 32
+
+enum fscc_latency_stage {
+	FSCC_LATENCY_RX_ISR_TO_TASKLET = 0,
+	FSCC_LATENCY_RX_TASKLET_TO_QUEUE,
+	FSCC_LATENCY_RX_QUEUE_TO_USER,
+	FSCC_LATENCY_RX_TOTAL,
+	FSCC_LATENCY_TX_WRITE_TO_HANDOFF,
+	FSCC_LATENCY_TX_HANDOFF_TO_COMPLETE,
+	FSCC_LATENCY_TX_TOTAL,
+	FSCC_LATENCY_STAGES
+};
+
+struct fscc_latency {
+	__u64 buckets[FSCC_LATENCY_STAGES][FSCC_LATENCY_BUCKETS];
+};
+
+struct fscc_port;
+
+static inline __u64 fscc_latency_now(void)
+{
+	return ktime_to_ns(ktime_get());
+}
+
+struct fscc_latency __percpu *fscc_latency_new(void);
+void fscc_latency_delete(struct fscc_latency __percpu *latency);
+void fscc_latency_record(struct fscc_latency __percpu *latency,
+						 unsigned stage, __u64 start, __u64 end);
+
+void fscc_latency_debugfs_init(void);
+void fscc_latency_debugfs_exit(void);
+void fscc_latency_debugfs_create(struct fscc_port *port);
+void fscc_latency_debugfs_remove(struct fscc_port *port);
+
+#endif
@@ -19,11 +19,17 @@
 */
 
 #include <linux/poll.h> /* poll_wait, POLL* */
+#include <linux/slab.h> /* kmalloc */
+#include <asm/uaccess.h> /* copy_{to,from}_user */
 #include "card.h" /* struct fscc_card */
 #include "port.h" /* struct fscc_port */
 #include "config.h" /* DEVICE_NAME, DEFAULT_* */
 #include "utils.h" /* is_fscc_device */
 
+#ifdef FSCC_EMULATED
+#include "emulated.h" /* fscc_emulated_create_cards */
+#endif
+
 #if defined(__BIG_ENDIAN) && defined(__LITTLE_ENDIAN)
 	#error Both __BIG_ENDIAN and __LITTLE_ENDIAN are defined
 #endif
@@ -36,6 +42,8 @@ static int fscc_major_number;
 static struct class *fscc_class = 0;
 
 unsigned force_fifo = DEFAULT_FORCE_FIFO_VALUE;
+unsigned memory_budget = DEFAULT_MEMORY_BUDGET_VALUE;
+unsigned memory_reserve = DEFAULT_MEMORY_RESERVE_VALUE;
 
 LIST_HEAD(fscc_cards);
 
@@ -73,6 +81,7 @@ int fscc_open(struct inode *inode, struct file *file)
 /*
 	Returns -ENOBUFS if read size is smaller than next frame
 	Returns -EOPNOTSUPP if in async mode
+	Returns -EOVERFLOW once after a receive overflow (if report_overflow is on)
 */
 ssize_t fscc_read(struct file *file, char *buf, size_t count, loff_t *ppos)
 {
@@ -89,28 +98,42 @@ ssize_t fscc_read(struct file *file, char *buf, size_t count, loff_t *ppos)
 		return -EOPNOTSUPP;
 	}
 
-	if (down_interruptible(&port->read_semaphore))
-		return -ERESTARTSYS;
+	if (fscc_port_take_overflow_report(port))
+		return -EOVERFLOW;
+
+	/*
+		Readers don't lock each other out. Each frame is removed from the
+		queue under its spinlock so it goes to exactly one reader, a reader
+		that finds the queue emptied by another one goes back to waiting.
+	*/
+	for (;;) {
+		/* Blocking reads wait for the wake thresholds, non-blocking reads
+		   take whatever is there. */
+		while (!fscc_port_has_incoming_data(port) ||
+			   (!(file->f_flags & O_NONBLOCK) && !fscc_port_rx_wake_ready(port))) {
+			if (file->f_flags & O_NONBLOCK)
+				return -EAGAIN;
+
+			if (wait_event_interruptible(port->input_queue,
+										 fscc_port_rx_wake_ready(port) ||
+										 fscc_port_has_overflow_report(port))) {
+				return -ERESTARTSYS;
+			}
+
+			if (fscc_port_take_overflow_report(port))
+				return -EOVERFLOW;
+		}
 
-	while (!fscc_port_has_incoming_data(port)) {
-		up(&port->read_semaphore);
+		read_count = fscc_port_read(port, buf, count);
 
-		if (file->f_flags & O_NONBLOCK)
-			return -EAGAIN;
+		/* Only go back to waiting if another reader drained the queue. */
+		if (read_count != 0 || fscc_port_has_incoming_data(port))
+			break;
 
-		if (wait_event_interruptible(port->input_queue,
-									 fscc_port_has_incoming_data(port))) {
-			return -ERESTARTSYS;
-		}
-
-		if (down_interruptible(&port->read_semaphore))
+		if (signal_pending(current))
 			return -ERESTARTSYS;
 	}
 
-	read_count = fscc_port_read(port, buf, count);
-
-	up(&port->read_semaphore);
-
 	return read_count;
 }
 
@@ -122,6 +145,9 @@ ssize_t fscc_write(struct file *file, const char *buf, size_t count,
 {
 	struct fscc_port *port = 0;
 	int error_code = 0;
+	unsigned needed_memory = 0;
+	unsigned zero_copy_sequence = 0;
+	unsigned zero_copy = 0;
 
 	port = file->private_data;
 
@@ -133,30 +159,66 @@ ssize_t fscc_write(struct file *file, const char *buf, size_t count,
 		return -EOPNOTSUPP;
 	}
 
-	if (count > fscc_port_get_output_memory_cap(port))
+	zero_copy = fscc_port_uses_zero_copy(port, count);
+
+	/* Non-blocking writers learn that the card is done with their buffer
+	   from the transmit reports, without those the frame is copied. */
+	if (zero_copy && (file->f_flags & O_NONBLOCK) &&
+		!fscc_port_get_tx_reports(port)) {
+		zero_copy = 0;
+	}
+
+	if (zero_copy)
+		needed_memory = fscc_frame_estimate_zero_copy_usage(count);
+	else
+		needed_memory = fscc_frame_estimate_memory_usage(count);
+
+	if (needed_memory > fscc_port_get_output_memory_cap(port)) {
+		fscc_stats_inc(port, tx_memory_cap_rejects);
 		return -ENOBUFS;
+	}
 
-	if (down_interruptible(&port->write_semaphore))
+	/* Keeps the memory cap check and the queueing together. */
+	if (mutex_lock_interruptible(&port->write_mutex))
 		return -ERESTARTSYS;
 
-	while (fscc_port_get_output_memory_usage(port) + count > fscc_port_get_output_memory_cap(port)) {
-		up(&port->write_semaphore);
+	while (fscc_port_get_output_memory_usage(port) + needed_memory > fscc_port_get_output_memory_limit(port)) {
+		mutex_unlock(&port->write_mutex);
 
-		if (file->f_flags & O_NONBLOCK)
+		if (file->f_flags & O_NONBLOCK) {
+			fscc_stats_inc(port, tx_memory_cap_rejects);
 			return -EAGAIN;
+		}
 
 		if (wait_event_interruptible(port->output_queue,
-				fscc_port_get_output_memory_usage(port) + count <= fscc_port_get_output_memory_cap(port))) {
+				fscc_port_get_output_memory_usage(port) + needed_memory <= fscc_port_get_output_memory_limit(port))) {
 			return -ERESTARTSYS;
 		}
 
-		if (down_interruptible(&port->write_semaphore))
+		if (mutex_lock_interruptible(&port->write_mutex))
 			return -ERESTARTSYS;
 	}
 
-	error_code = fscc_port_write(port, buf, count);
+	/* Keeps the frames in flight within what the report list can hold. */
+	if (zero_copy && (file->f_flags & O_NONBLOCK) &&
+		fscc_port_get_zero_copy_in_flight(port) >= FSCC_MAX_TX_REPORTS) {
+		mutex_unlock(&port->write_mutex);
+		return -EAGAIN;
+	}
+
+	zero_copy_sequence = port->tx_zero_copy_queued;
+
+	error_code = fscc_port_write(port, buf, count, zero_copy);
+
+	zero_copy = (port->tx_zero_copy_queued != zero_copy_sequence);
+	zero_copy_sequence = port->tx_zero_copy_queued;
+
+	mutex_unlock(&port->write_mutex);
 
-	up(&port->write_semaphore);
+	/* A blocking writer's buffer can't be handed back until the card is done
+	   with it, non-blocking writers wait for the frame's transmit report. */
+	if (zero_copy && !(file->f_flags & O_NONBLOCK))
+		fscc_port_wait_zero_copy(port, zero_copy_sequence);
 
 	return (error_code < 0) ? error_code : count;
 }
@@ -168,18 +230,20 @@ unsigned fscc_poll(struct file *file, struct poll_table_struct *wait)
 
 	port = file->private_data;
 
-	down(&port->poll_semaphore);
-
 	poll_wait(file, &port->input_queue, wait);
 	poll_wait(file, &port->output_queue, wait);
 
-	if (fscc_port_has_incoming_data(port))
+	if (fscc_port_rx_wake_ready(port))
 		mask |= POLLIN | POLLRDNORM;
 
-	if (fscc_port_get_output_memory_usage(port) < fscc_port_get_output_memory_cap(port))
+	if (fscc_port_has_overflow_report(port))
+		mask |= POLLERR;
+
+	if (fscc_port_tx_wake_ready(port))
 		mask |= POLLOUT | POLLWRNORM;
 
-	up(&port->poll_semaphore);
+	if (fscc_port_has_tx_reports(port))
+		mask |= POLLPRI;
 
 	return mask;
 }
@@ -204,10 +268,32 @@ int fscc_ioctl(struct inode *inode, struct file *file, unsigned int cmd,
 		spin_unlock_irqrestore(&port->board_settings_spinlock, flags);
 		break;
 
-	case FSCC_SET_REGISTERS:
-		spin_lock_irqsave(&port->board_settings_spinlock, flags);
-		fscc_port_set_registers(port, (struct fscc_registers *)arg);
-		spin_unlock_irqrestore(&port->board_settings_spinlock, flags);
+	case FSCC_SET_REGISTERS: {
+			struct fscc_registers *regs = 0;
+
+			/* Too big for the stack. */
+			regs = kmalloc(sizeof(*regs), GFP_KERNEL);
+
+			if (!regs)
+				return -ENOMEM;
+
+			if (copy_from_user(regs, (struct fscc_registers *)arg,
+							   sizeof(*regs))) {
+				kfree(regs);
+				return -EFAULT;
+			}
+
+			spin_lock_irqsave(&port->board_settings_spinlock, flags);
+			fscc_port_set_registers(port, regs);
+
+			if (regs->FIFOT >= 0)
+				fscc_fifot_pin(port);
+
+			spin_unlock_irqrestore(&port->board_settings_spinlock, flags);
+
+			kfree(regs);
+		}
+
 		break;
 
 	case FSCC_PURGE_TX:
@@ -250,6 +336,85 @@ int fscc_ioctl(struct inode *inode, struct file *file, unsigned int cmd,
 		*(unsigned *)arg = fscc_port_get_append_timestamp(port);
 		break;
 
+	case FSCC_ENABLE_APPEND_SEQUENCE:
+		if ((error_code = fscc_port_set_append_sequence(port, 1)) < 0)
+			return error_code;
+
+		break;
+
+	case FSCC_DISABLE_APPEND_SEQUENCE:
+		fscc_port_set_append_sequence(port, 0);
+		break;
+
+	case FSCC_GET_APPEND_SEQUENCE:
+		*(unsigned *)arg = fscc_port_get_append_sequence(port);
+		break;
+
+	case FSCC_SET_TIMESTAMP_CLOCK:
+		if ((error_code = fscc_port_set_timestamp_clock(port, (unsigned)arg)) < 0)
+			return error_code;
+		break;
+
+	case FSCC_GET_TIMESTAMP_CLOCK:
+		*(unsigned *)arg = fscc_port_get_timestamp_clock(port);
+		break;
+
+	case FSCC_ENABLE_TX_REPORTS:
+		fscc_port_set_tx_reports(port, 1);
+		break;
+
+	case FSCC_DISABLE_TX_REPORTS:
+		fscc_port_set_tx_reports(port, 0);
+		break;
+
+	case FSCC_GET_TX_REPORTS:
+		*(unsigned *)arg = fscc_port_get_tx_reports(port);
+		break;
+
+	case FSCC_SET_TX_COOKIE: {
+			__u64 cookie = 0;
+
+			if (copy_from_user(&cookie, (__u64 *)arg, sizeof(cookie)))
+				return -EFAULT;
+
+			if ((error_code = fscc_port_set_tx_cookie(port, cookie)) < 0)
+				return error_code;
+		}
+
+		break;
+
+	case FSCC_READ_TX_REPORTS: {
+			struct fscc_tx_reports *reports = 0;
+
+			reports = kmalloc(sizeof(*reports), GFP_KERNEL);
+
+			if (!reports)
+				return -ENOMEM;
+
+			fscc_port_take_tx_reports(port, reports);
+
+			if (copy_to_user((struct fscc_tx_reports *)arg, reports,
+							 sizeof(*reports))) {
+				kfree(reports);
+				return -EFAULT;
+			}
+
+			kfree(reports);
+		}
+
+		break;
+
+	case FSCC_GET_RX_DROPS: {
+			struct fscc_rx_drops drops;
+
+			fscc_port_take_rx_drops(port, &drops);
+
+			if (copy_to_user((struct fscc_rx_drops *)arg, &drops, sizeof(drops)))
+				return -EFAULT;
+		}
+
+		break;
+
 	case FSCC_SET_MEMORY_CAP:
 		fscc_port_set_memory_cap(port, (struct fscc_memory_cap *)arg);
 		break;
@@ -296,6 +461,167 @@ int fscc_ioctl(struct inode *inode, struct file *file, unsigned int cmd,
 		*(unsigned *)arg = fscc_port_get_rx_multiple(port);
 		break;
 
+	case FSCC_ENABLE_REPORT_OVERFLOW:
+		fscc_port_set_report_overflow(port, 1);
+		break;
+
+	case FSCC_DISABLE_REPORT_OVERFLOW:
+		fscc_port_set_report_overflow(port, 0);
+		break;
+
+	case FSCC_GET_REPORT_OVERFLOW:
+		*(unsigned *)arg = fscc_port_get_report_overflow(port);
+		break;
+
+	case FSCC_SET_INPUT_CAP_POLICY:
+		if ((error_code = fscc_port_set_input_cap_policy(port, (unsigned)arg)) < 0)
+			return error_code;
+		break;
+
+	case FSCC_GET_INPUT_CAP_POLICY:
+		*(unsigned *)arg = fscc_port_get_input_cap_policy(port);
+		break;
+
+	case FSCC_SET_FLUSH_TIMEOUT:
+		if ((error_code = fscc_port_set_flush_timeout(port, (unsigned)arg)) < 0)
+			return error_code;
+		break;
+
+	case FSCC_GET_FLUSH_TIMEOUT:
+		*(unsigned *)arg = fscc_port_get_flush_timeout(port);
+		break;
+
+	case FSCC_SET_TX_ZERO_COPY:
+		if ((error_code = fscc_port_set_tx_zero_copy(port, (unsigned)arg)) < 0)
+			return error_code;
+		break;
+
+	case FSCC_GET_TX_ZERO_COPY:
+		*(unsigned *)arg = fscc_port_get_tx_zero_copy(port);
+		break;
+
+	case FSCC_SET_RX_FILTER: {
+			struct sock_fprog fprog;
+
+			if (copy_from_user(&fprog, (struct sock_fprog *)arg, sizeof(fprog)))
+				return -EFAULT;
+
+			if ((error_code = fscc_port_set_rx_filter(port, &fprog)) < 0)
+				return error_code;
+		}
+
+		break;
+
+	case FSCC_CLEAR_RX_FILTER:
+		fscc_port_set_rx_filter(port, 0);
+		break;
+
+	case FSCC_SET_ADDRESS_FILTER: {
+			struct fscc_address_filter *filter = 0;
+
+			/* Too big for the stack. */
+			filter = kmalloc(sizeof(*filter), GFP_KERNEL);
+
+			if (!filter)
+				return -ENOMEM;
+
+			if (copy_from_user(filter, (struct fscc_address_filter *)arg,
+							   sizeof(*filter))) {
+				kfree(filter);
+				return -EFAULT;
+			}
+
+			error_code = fscc_port_set_address_filter(port, filter);
+
+			kfree(filter);
+
+			if (error_code < 0)
+				return error_code;
+		}
+
+		break;
+
+	case FSCC_GET_ADDRESS_FILTER: {
+			struct fscc_address_filter *filter = 0;
+
+			filter = kmalloc(sizeof(*filter), GFP_KERNEL);
+
+			if (!filter)
+				return -ENOMEM;
+
+			fscc_port_get_address_filter(port, filter);
+
+			if (copy_to_user((struct fscc_address_filter *)arg, filter,
+							 sizeof(*filter))) {
+				kfree(filter);
+				return -EFAULT;
+			}
+
+			kfree(filter);
+		}
+
+		break;
+
+	case FSCC_CLEAR_ADDRESS_FILTER:
+		fscc_port_set_address_filter(port, 0);
+		break;
+
+	case FSCC_SET_FIFOT_ADAPT: {
+			struct fscc_fifot_adapt adapt;
+
+			if (copy_from_user(&adapt, (struct fscc_fifot_adapt *)arg, sizeof(adapt)))
+				return -EFAULT;
+
+			if ((error_code = fscc_fifot_set_adapt(port, &adapt)) < 0)
+				return error_code;
+		}
+
+		break;
+
+	case FSCC_GET_FIFOT_ADAPT: {
+			struct fscc_fifot_adapt adapt;
+
+			fscc_fifot_get_adapt(port, &adapt);
+
+			if (copy_to_user((struct fscc_fifot_adapt *)arg, &adapt, sizeof(adapt)))
+				return -EFAULT;
+		}
+
+		break;
+
+	case FSCC_SET_WAKEUP: {
+			struct fscc_wakeup wakeup;
+
+			if (copy_from_user(&wakeup, (struct fscc_wakeup *)arg, sizeof(wakeup)))
+				return -EFAULT;
+
+			fscc_port_set_wakeup(port, &wakeup);
+		}
+
+		break;
+
+	case FSCC_GET_WAKEUP: {
+			struct fscc_wakeup wakeup;
+
+			fscc_port_get_wakeup(port, &wakeup);
+
+			if (copy_to_user((struct fscc_wakeup *)arg, &wakeup, sizeof(wakeup)))
+				return -EFAULT;
+		}
+
+		break;
+
+	case FSCC_GET_STATS: {
+			struct fscc_stats stats;
+
+			fscc_port_get_stats(port, &stats);
+
+			if (copy_to_user((struct fscc_stats *)arg, &stats, sizeof(stats)))
+				return -EFAULT;
+		}
+
+		break;
+
 	default:
 		dev_dbg(port->device, "unknown ioctl 0x%x\n", cmd);
 		return -ENOTTY;
@@ -395,10 +721,17 @@ static int __init fscc_init(void)
 {
 	int error_code = 0;
 
+	fscc_latency_debugfs_init();
+
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(6, 4, 0)
+	fscc_class = class_create(DEVICE_NAME);
+#else
 	fscc_class = class_create(THIS_MODULE, DEVICE_NAME);
+#endif
 
 	if (IS_ERR(fscc_class)) {
 		printk(KERN_ERR DEVICE_NAME " class_create failed\n");
+		fscc_latency_debugfs_exit();
 		return PTR_ERR(fscc_class);
 	}
 
@@ -407,6 +740,7 @@ static int __init fscc_init(void)
 	if (fscc_major_number < 0) {
 		printk(KERN_ERR DEVICE_NAME " register_chrdev failed\n");
 		class_destroy(fscc_class);
+		fscc_latency_debugfs_exit();
 		return error_code;
 	}
 
@@ -416,6 +750,7 @@ static int __init fscc_init(void)
 		printk(KERN_ERR DEVICE_NAME " pci_register_driver failed\n");
 		unregister_chrdev(fscc_major_number, "fscc");
 		class_destroy(fscc_class);
+		fscc_latency_debugfs_exit();
 		return error_code;
 	}
 
@@ -443,19 +778,34 @@ static int __init fscc_init(void)
 			pdev = pci_get_device(COMMTECH_VENDOR_ID, PCI_ANY_ID, pdev);
 		}
 
+#ifdef FSCC_EMULATED
+		num_devices += fscc_emulated_create_cards(&fscc_cards,
+												  fscc_major_number,
+												  fscc_class, &fscc_fops);
+#endif
+
 		if (num_devices == 0) {
 			pci_unregister_driver(&fscc_pci_driver);
 		    unregister_chrdev(fscc_major_number, "fscc");
 		    class_destroy(fscc_class);
+			fscc_latency_debugfs_exit();
 			return -ENODEV;
 		}
 	}
 
+	if (fscc_budget_sysfs_create(&fscc_pci_driver.driver) < 0)
+		printk(KERN_WARNING DEVICE_NAME " memory_usage attribute failed\n");
+
+	fscc_budget_init();
+
 #ifdef DEBUG
 	printk(KERN_INFO DEVICE_NAME " setting: debug (on)\n");
 
 	printk(KERN_INFO DEVICE_NAME " setting: force_fifo (%s)\n",
 		   (force_fifo) ? "on" : "off");
+
+	printk(KERN_INFO DEVICE_NAME " setting: memory_budget (%u)\n",
+		   memory_budget);
 #endif
 
 	return 0;
@@ -466,6 +816,9 @@ static void __exit fscc_exit(void)
 	struct list_head *current_node = 0;
 	struct list_head *temp_node = 0;
 
+	fscc_budget_exit();
+	fscc_budget_sysfs_remove(&fscc_pci_driver.driver);
+
 	list_for_each_safe(current_node, temp_node, &fscc_cards) {
 		struct fscc_card *current_card = 0;
 
@@ -478,6 +831,7 @@ static void __exit fscc_exit(void)
 	pci_unregister_driver(&fscc_pci_driver);
 	unregister_chrdev(fscc_major_number, DEVICE_NAME);
 	class_destroy(fscc_class);
+	fscc_latency_debugfs_exit();
 }
 
 MODULE_DEVICE_TABLE(pci, fscc_id_table);
@@ -491,6 +845,12 @@ MODULE_DESCRIPTION("Driver for the FSCC series of cards from Commtech, Inc.");
 module_param(force_fifo, int, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
 MODULE_PARM_DESC(force_fifo, "Disables DMA (SuperFSCC* series), forcing FIFO operation.");
 
+module_param(memory_budget, uint, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+MODULE_PARM_DESC(memory_budget, "Bytes of memory shared by all ports (0 = only per-port memory caps).");
+
+module_param(memory_reserve, uint, S_IRUSR | S_IRGRP | S_IROTH);
+MODULE_PARM_DESC(memory_reserve, "Bytes of the memory budget guaranteed to each port.");
+
 module_init(fscc_init);
 module_exit(fscc_exit);
 
@@ -0,0 +1,199 @@
+/*
+	Copyright (C) 2014 Commtech, Inc.
+
+	This file is part of fscc-linux.
+
+	fscc-linux is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	fscc-linux is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with fscc-linux.	If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include <linux/slab.h> /* kmalloc */
+#include <linux/seq_file.h> /* seq_*, single_open */
+#include <linux/sched.h> /* cond_resched */
+
+#include "microbench.h"
+#include "frame.h" /* struct fscc_frame */
+#include "flist.h" /* struct fscc_flist */
+#include "latency.h" /* fscc_latency_now */
+#include "config.h" /* SYSFS_READ_ONLY_MODE */
+#include "utils.h" /* return_{val_}if_untrue */
+
+/*
+	Times the frame and frame list primitives on frames that don't belong to a
+	port, so nothing here touches a card. Reading the debugfs file runs every
+	size once and prints the average cost of each operation in nanoseconds.
+	The list's correctness is covered by the KUnit suite in flist_test.c.
+*/
+
+static unsigned sizes[] = { 16, 64, 256, 1024, 4096, 16384, 65536 };
+
+struct fscc_microbench_result {
+	__u64 add_data;
+	__u64 remove_data;
+	__u64 flist_add;
+	__u64 flist_remove;
+};
+
+/* Fills a frame the way the FIFO path does, one chunk at a time. */
+static int fill_frame(struct fscc_frame *frame, const char *data, unsigned size)
+{
+	unsigned offset = 0;
+
+	for (offset = 0; offset < size; offset += FSCC_MICROBENCH_CHUNK_SIZE) {
+		unsigned length = min_t(unsigned, FSCC_MICROBENCH_CHUNK_SIZE,
+		                        size - offset);
+
+		if (fscc_frame_add_data(frame, data + offset, length) == 0)
+			return 0;
+	}
+
+	return 1;
+}
+
+static int run_size(const char *data, unsigned size,
+                    struct fscc_microbench_result *result)
+{
+	struct fscc_frame **frames = 0;
+	struct fscc_flist flist;
+	unsigned iterations = 0;
+	unsigned i = 0;
+	unsigned offset = 0;
+	__u64 start = 0;
+	int error_code = 0;
+
+	iterations = max_t(unsigned, FSCC_MICROBENCH_BYTES / size,
+	                   FSCC_MICROBENCH_MIN_ITERATIONS);
+
+	frames = kzalloc(iterations * sizeof(*frames), GFP_KERNEL);
+
+	return_val_if_untrue(frames, -ENOMEM);
+
+	fscc_flist_init(&flist);
+
+	start = fscc_latency_now();
+
+	for (i = 0; i < iterations; i++) {
+		frames[i] = fscc_frame_new(0);
+
+		if (!frames[i] || !fill_frame(frames[i], data, size)) {
+			error_code = -ENOMEM;
+			goto cleanup;
+		}
+	}
+
+	result->add_data = (fscc_latency_now() - start) / iterations;
+
+	start = fscc_latency_now();
+
+	for (i = 0; i < iterations; i++)
+		fscc_flist_add_frame(&flist, frames[i]);
+
+	result->flist_add = (fscc_latency_now() - start) / iterations;
+
+	start = fscc_latency_now();
+
+	for (i = 0; i < iterations; i++)
+		frames[i] = fscc_flist_remove_frame_if_lte(&flist, size);
+
+	result->flist_remove = (fscc_latency_now() - start) / iterations;
+
+	cond_resched();
+
+	/* Drains the frames the way a reader smaller than the frame does. */
+	start = fscc_latency_now();
+
+	for (i = 0; i < iterations; i++) {
+		if (!frames[i]) {
+			error_code = -EINVAL;
+			goto cleanup;
+		}
+
+		for (offset = 0; offset < size; offset += FSCC_MICROBENCH_CHUNK_SIZE) {
+			unsigned length = min_t(unsigned, FSCC_MICROBENCH_CHUNK_SIZE,
+			                        size - offset);
+
+			fscc_frame_remove_data(frames[i], 0, length);
+		}
+	}
+
+	result->remove_data = (fscc_latency_now() - start) / iterations;
+
+cleanup:
+	fscc_flist_clear(&flist);
+
+	for (i = 0; i < iterations; i++)
+		fscc_frame_delete(frames[i]);
+
+	kfree(frames);
+
+	return error_code;
+}
+
+static int fscc_microbench_show(struct seq_file *m, void *v)
+{
+	struct fscc_microbench_result result;
+	char *data = 0;
+	unsigned i = 0;
+	int error_code = 0;
+
+	data = kmalloc(FSCC_MICROBENCH_MAX_SIZE, GFP_KERNEL);
+
+	return_val_if_untrue(data, -ENOMEM);
+
+	memset(data, 0x55, FSCC_MICROBENCH_MAX_SIZE);
+
+	seq_printf(m, "%8s %12s %12s %12s %12s\n", "size", "add_data",
+	           "remove_data", "flist_add", "flist_remove");
+
+	for (i = 0; i < ARRAY_SIZE(sizes); i++) {
+		memset(&result, 0, sizeof(result));
+
+		error_code = run_size(data, sizes[i], &result);
+
+		if (error_code < 0)
+			break;
+
+		seq_printf(m, "%8u %12llu %12llu %12llu %12llu\n", sizes[i],
+		           result.add_data, result.remove_data, result.flist_add,
+		           result.flist_remove);
+
+		cond_resched();
+	}
+
+	kfree(data);
+
+	return error_code;
+}
+
+static int fscc_microbench_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, fscc_microbench_show, inode->i_private);
+}
+
+static const struct file_operations fscc_microbench_fops = {
+	.owner = THIS_MODULE,
+	.open = fscc_microbench_open,
+	.read = seq_read,
+	.llseek = seq_lseek,
+	.release = single_release,
+};
+
+void fscc_microbench_debugfs_create(struct dentry *parent)
+{
+	if (IS_ERR_OR_NULL(parent))
+		return;
+
+	debugfs_create_file("microbench", SYSFS_READ_ONLY_MODE, parent, 0,
+	                    &fscc_microbench_fops);
+}
@@ -0,0 +1,38 @@
+/*
+	Copyright (C) 2014 Commtech, Inc.
+
+	This file is part of fscc-linux.
+
+	fscc-linux is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	fscc-linux is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with fscc-linux.	If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef FSCC_MICROBENCH_H
+#define FSCC_MICROBENCH_H
+
+#include <linux/debugfs.h> /* struct dentry */
+
+/* Frames are filled and drained this many bytes at a time, about what one
+   FIFO trigger interrupt moves. */
+#define FSCC_MICROBENCH_CHUNK_SIZE 256
+
+/* Each frame size gets enough iterations to move roughly this many bytes. */
+#define FSCC_MICROBENCH_BYTES (1024 * 1024)
+
+#define FSCC_MICROBENCH_MIN_ITERATIONS 16
+#define FSCC_MICROBENCH_MAX_SIZE 65536
+
+void fscc_microbench_debugfs_create(struct dentry *parent);
+
+#endif
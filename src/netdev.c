@@ -0,0 +1,587 @@
+/*
+	Copyright (C) 2014 Commtech, Inc.
+
+	This file is part of fscc-linux.
+
+	fscc-linux is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	fscc-linux is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with fscc-linux.	If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include <linux/module.h> /* module_param */
+#include <linux/netdevice.h> /* struct net_device, napi_* */
+#include <linux/skbuff.h> /* struct sk_buff */
+#include <linux/hdlc.h> /* alloc_hdlcdev, hdlc_* */
+#include <linux/version.h> /* LINUX_VERSION_CODE, KERNEL_VERSION */
+
+#include "netdev.h"
+#include "port.h" /* struct fscc_port */
+#include "frame.h" /* struct fscc_frame */
+#include "utils.h" /* return_{val_}if_untrue */
+
+#ifdef FSCC_XDP
+#include <linux/bpf.h> /* struct bpf_prog */
+#include <linux/filter.h> /* bpf_prog_run_xdp, xdp_do_* */
+#include <net/xdp.h> /* struct xdp_buff, xdp_rxq_info_* */
+#include <trace/events/xdp.h> /* trace_xdp_exception */
+#endif
+
+/*
+	Registers each port with the generic HDLC layer so it can be used through
+	the networking stack (sockets, packet capture, qdiscs) as well as through
+	its character device. The two share the port's frame queues. Received
+	frames are pulled off queued_iframes by NAPI while the interface is up, and
+	transmitted packets are queued on queued_oframes like frames from write(),
+	so they take the same DMA or FIFO path.
+*/
+
+static unsigned hdlc_netdev = 0;
+
+static inline struct fscc_port *dev_to_port(struct net_device *dev)
+{
+	return dev_to_hdlc(dev)->priv;
+}
+
+/* Unlike fscc_port_has_incoming_data this ignores the transparent stream. */
+static unsigned fscc_netdev_has_iframes(struct fscc_port *port)
+{
+	unsigned long queued_flags = 0;
+	unsigned empty = 0;
+
+	spin_lock_irqsave(&port->queued_iframes_spinlock, queued_flags);
+	empty = fscc_flist_is_empty(&port->queued_iframes);
+	spin_unlock_irqrestore(&port->queued_iframes_spinlock, queued_flags);
+
+	return !empty;
+}
+
+/* Line settings come from the port's registers, nothing to program here. */
+static int fscc_netdev_attach(struct net_device *dev, unsigned short encoding,
+							  unsigned short parity)
+{
+	if (encoding != ENCODING_NRZ)
+		return -EINVAL;
+
+	return 0;
+}
+
+static void fscc_netdev_receive_frame(struct fscc_port *port,
+									  struct fscc_frame *frame,
+									  unsigned length)
+{
+	struct net_device *dev = port->netdev;
+	struct sk_buff *skb = 0;
+
+	skb = netdev_alloc_skb(dev, length);
+
+	if (!skb) {
+		dev->stats.rx_dropped++;
+		fscc_frame_delete(frame);
+		return;
+	}
+
+	memcpy(skb_put(skb, length), frame->buffer, length);
+	fscc_frame_delete(frame);
+
+	skb->protocol = hdlc_type_trans(skb, dev);
+
+	dev->stats.rx_packets++;
+	dev->stats.rx_bytes += length;
+
+	netif_receive_skb(skb);
+}
+
+#ifdef FSCC_XDP
+/*
+	Queues data for transmit from XDP, either XDP_TX or a redirect from
+	another interface. There is no queue to stop here so frames that don't
+	fit under the output memory cap are dropped.
+*/
+static int fscc_netdev_xdp_queue(struct fscc_port *port, void *data,
+								 unsigned length)
+{
+	struct fscc_frame *frame = 0;
+
+	if (fscc_port_get_output_memory_usage(port) +
+		fscc_frame_estimate_memory_usage(length) >
+		fscc_port_get_output_memory_limit(port)) {
+		fscc_stats_inc(port, tx_memory_cap_rejects);
+		return 0;
+	}
+
+	frame = fscc_frame_new(port);
+
+	if (!frame || !fscc_frame_add_data(frame, data, length)) {
+		fscc_frame_delete(frame);
+		return 0;
+	}
+
+	port->netdev->stats.tx_packets++;
+	port->netdev->stats.tx_bytes += length;
+
+	fscc_port_queue_frame(port, frame);
+
+	return 1;
+}
+
+/*
+	Runs the attached XDP program on a received frame. The FIFO is read by
+	the CPU so the data has to be copied once anyway, it goes into a page
+	with XDP headroom so a passed frame becomes an skb without another copy
+	and a redirected one can go straight to an AF_XDP socket or another
+	interface. Returns 1 if the frame was a redirect that needs a flush.
+*/
+static unsigned fscc_netdev_run_xdp(struct fscc_port *port,
+									struct bpf_prog *prog,
+									struct fscc_frame *frame,
+									unsigned length)
+{
+	struct net_device *dev = port->netdev;
+	struct xdp_buff xdp;
+	struct sk_buff *skb = 0;
+	struct page *page = 0;
+	unsigned action = 0;
+
+	/* The card doesn't hold received frames to the MTU. */
+	if (length > FSCC_XDP_MAX_FRAME) {
+		dev->stats.rx_length_errors++;
+		dev->stats.rx_dropped++;
+		fscc_frame_delete(frame);
+		return 0;
+	}
+
+	page = dev_alloc_page();
+
+	if (!page) {
+		dev->stats.rx_dropped++;
+		fscc_frame_delete(frame);
+		return 0;
+	}
+
+	memcpy(page_address(page) + XDP_PACKET_HEADROOM, frame->buffer, length);
+	fscc_frame_delete(frame);
+
+	xdp_init_buff(&xdp, PAGE_SIZE, &port->xdp_rxq);
+	xdp_prepare_buff(&xdp, page_address(page), XDP_PACKET_HEADROOM, length,
+					 false);
+
+	action = bpf_prog_run_xdp(prog, &xdp);
+	length = xdp.data_end - xdp.data;
+
+	switch (action) {
+	case XDP_PASS:
+		skb = build_skb(xdp.data_hard_start, PAGE_SIZE);
+
+		if (!skb)
+			break;
+
+		skb_reserve(skb, xdp.data - xdp.data_hard_start);
+		skb_put(skb, length);
+
+		skb->protocol = hdlc_type_trans(skb, dev);
+
+		dev->stats.rx_packets++;
+		dev->stats.rx_bytes += length;
+
+		netif_receive_skb(skb);
+		return 0;
+
+	case XDP_TX:
+		if (fscc_netdev_xdp_queue(port, xdp.data, length))
+			dev->stats.rx_packets++;
+		else
+			dev->stats.tx_dropped++;
+
+		put_page(page);
+		return 0;
+
+	case XDP_REDIRECT:
+		if (xdp_do_redirect(dev, &xdp, prog) < 0)
+			break;
+
+		dev->stats.rx_packets++;
+		dev->stats.rx_bytes += length;
+		return 1;
+
+	case XDP_DROP:
+		put_page(page);
+		return 0;
+
+	default:
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(5, 17, 0)
+		bpf_warn_invalid_xdp_action(dev, prog, action);
+#else
+		bpf_warn_invalid_xdp_action(action);
+#endif
+		fallthrough;
+
+	case XDP_ABORTED:
+		trace_xdp_exception(dev, prog, action);
+		break;
+	}
+
+	dev->stats.rx_dropped++;
+	put_page(page);
+
+	return 0;
+}
+#endif /* FSCC_XDP */
+
+static int fscc_netdev_poll(struct napi_struct *napi, int budget)
+{
+	struct fscc_port *port = container_of(napi, struct fscc_port, napi);
+	struct fscc_frame *frame = 0;
+	unsigned long queued_flags = 0;
+	int received = 0;
+#ifdef FSCC_XDP
+	struct bpf_prog *prog = 0;
+	unsigned redirected = 0;
+#endif
+
+#ifdef FSCC_XDP
+	rcu_read_lock();
+	prog = rcu_dereference(port->xdp_prog);
+#endif
+
+	while (received < budget) {
+		unsigned length = 0;
+
+		spin_lock_irqsave(&port->queued_iframes_spinlock, queued_flags);
+		frame = fscc_flist_remove_frame(&port->queued_iframes);
+		spin_unlock_irqrestore(&port->queued_iframes_spinlock, queued_flags);
+
+		if (!frame)
+			break;
+
+		received++;
+
+		fscc_latency_record(port->latency, FSCC_LATENCY_RX_QUEUE_TO_USER,
+							frame->queued_time, fscc_latency_now());
+
+		/* The status bytes are always at the end of a received frame. */
+		length = fscc_frame_get_length(frame);
+		length -= min(length, (unsigned)STATUS_LENGTH);
+
+#ifdef FSCC_XDP
+		if (prog) {
+			redirected |= fscc_netdev_run_xdp(port, prog, frame, length);
+			continue;
+		}
+#endif
+
+		fscc_netdev_receive_frame(port, frame, length);
+	}
+
+#ifdef FSCC_XDP
+	if (redirected)
+		xdp_do_flush();
+
+	rcu_read_unlock();
+#endif
+
+	fscc_port_unblock_rx(port);
+	fscc_budget_release(port);
+
+	if (received < budget) {
+		napi_complete(napi);
+
+		/* A frame queued between the last check and napi_complete. */
+		if (fscc_netdev_has_iframes(port))
+			napi_schedule(napi);
+	}
+
+	return received;
+}
+
+/* Whether a packet as large as the MTU still fits under the output cap. */
+static unsigned fscc_netdev_tx_has_room(struct fscc_port *port)
+{
+	return fscc_port_get_output_memory_usage(port) +
+		   fscc_frame_estimate_memory_usage(port->netdev->mtu) <=
+		   fscc_port_get_output_memory_limit(port);
+}
+
+static netdev_tx_t fscc_netdev_xmit(struct sk_buff *skb, struct net_device *dev)
+{
+	struct fscc_port *port = dev_to_port(dev);
+	struct fscc_frame *frame = 0;
+	unsigned needed_memory = 0;
+
+	needed_memory = fscc_frame_estimate_memory_usage(skb->len);
+
+	if (needed_memory > fscc_port_get_output_memory_cap(port)) {
+		fscc_stats_inc(port, tx_memory_cap_rejects);
+		dev->stats.tx_dropped++;
+		dev_kfree_skb(skb);
+		return NETDEV_TX_OK;
+	}
+
+	/* The queue is stopped before it fills, so this only happens when
+	   write() or the shared memory budget took the room first. */
+	if (fscc_port_get_output_memory_usage(port) + needed_memory >
+		fscc_port_get_output_memory_limit(port)) {
+		fscc_stats_inc(port, tx_memory_cap_rejects);
+		dev->stats.tx_dropped++;
+		dev_kfree_skb(skb);
+		return NETDEV_TX_OK;
+	}
+
+	frame = fscc_frame_new(port);
+
+	if (!frame || !fscc_frame_add_data(frame, skb->data, skb->len)) {
+		fscc_frame_delete(frame);
+		dev->stats.tx_dropped++;
+		dev_kfree_skb(skb);
+		return NETDEV_TX_OK;
+	}
+
+	dev->stats.tx_packets++;
+	dev->stats.tx_bytes += skb->len;
+
+	dev_kfree_skb(skb);
+
+	fscc_port_queue_frame(port, frame);
+
+	/* Stop while the next packet might not fit, fscc_netdev_tx_wake starts
+	   the queue again once sent frames have been cleared. */
+	if (!fscc_netdev_tx_has_room(port)) {
+		netif_stop_queue(dev);
+
+		/* Frames may have been cleared before the queue was stopped. */
+		if (fscc_netdev_tx_has_room(port))
+			netif_wake_queue(dev);
+	}
+
+	return NETDEV_TX_OK;
+}
+
+static int fscc_netdev_open(struct net_device *dev)
+{
+	struct fscc_port *port = dev_to_port(dev);
+	int error_code = 0;
+
+	error_code = hdlc_open(dev);
+
+	if (error_code < 0)
+		return error_code;
+
+	napi_enable(&port->napi);
+	port->netdev_up = 1;
+	netif_start_queue(dev);
+
+	/* Frames that arrived while the interface was down. */
+	if (fscc_netdev_has_iframes(port))
+		napi_schedule(&port->napi);
+
+	return 0;
+}
+
+static int fscc_netdev_stop(struct net_device *dev)
+{
+	struct fscc_port *port = dev_to_port(dev);
+
+	netif_stop_queue(dev);
+	port->netdev_up = 0;
+	napi_disable(&port->napi);
+
+	hdlc_close(dev);
+
+	return 0;
+}
+
+#ifdef FSCC_XDP
+static int fscc_netdev_xdp_setup(struct net_device *dev, struct bpf_prog *prog,
+								 struct netlink_ext_ack *extack)
+{
+	struct fscc_port *port = dev_to_port(dev);
+	struct bpf_prog *old_prog = 0;
+
+	if (prog && dev->mtu > FSCC_XDP_MAX_FRAME) {
+		NL_SET_ERR_MSG_MOD(extack, "MTU too large for XDP");
+		return -EOPNOTSUPP;
+	}
+
+	old_prog = rcu_replace_pointer(port->xdp_prog, prog, lockdep_rtnl_is_held());
+
+	if (old_prog)
+		bpf_prog_put(old_prog);
+
+	return 0;
+}
+
+static int fscc_netdev_bpf(struct net_device *dev, struct netdev_bpf *bpf)
+{
+	switch (bpf->command) {
+	case XDP_SETUP_PROG:
+		return fscc_netdev_xdp_setup(dev, bpf->prog, bpf->extack);
+
+	default:
+		return -EINVAL;
+	}
+}
+
+/* Frames redirected to this interface from XDP elsewhere. */
+static int fscc_netdev_xdp_xmit(struct net_device *dev, int count,
+								struct xdp_frame **frames, unsigned flags)
+{
+	struct fscc_port *port = dev_to_port(dev);
+	int sent = 0;
+
+	if (!fscc_netdev_is_up(port))
+		return -ENETDOWN;
+
+	for (sent = 0; sent < count; sent++) {
+		if (!fscc_netdev_xdp_queue(port, frames[sent]->data,
+								   frames[sent]->len))
+			break;
+
+		xdp_return_frame(frames[sent]);
+	}
+
+	return sent;
+}
+#endif /* FSCC_XDP */
+
+static const struct net_device_ops fscc_netdev_ops = {
+	.ndo_open = fscc_netdev_open,
+	.ndo_stop = fscc_netdev_stop,
+	.ndo_start_xmit = hdlc_start_xmit,
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(5, 15, 0)
+	.ndo_siocwandev = hdlc_ioctl,
+#else
+	.ndo_do_ioctl = hdlc_ioctl,
+#endif
+#ifdef FSCC_XDP
+	.ndo_bpf = fscc_netdev_bpf,
+	.ndo_xdp_xmit = fscc_netdev_xdp_xmit,
+#endif
+};
+
+/* The interface is named after the port so the two are easy to match up. */
+int fscc_netdev_create(struct fscc_port *port)
+{
+	struct net_device *dev = 0;
+	hdlc_device *hdlc = 0;
+	int error_code = 0;
+
+	return_val_if_untrue(port, 0);
+
+	port->netdev = 0;
+	port->netdev_up = 0;
+
+#ifdef FSCC_XDP
+	RCU_INIT_POINTER(port->xdp_prog, NULL);
+#endif
+
+	if (!hdlc_netdev)
+		return 0;
+
+	dev = alloc_hdlcdev(port);
+
+	if (!dev) {
+		dev_err(port->device, "alloc_hdlcdev failed\n");
+		return -ENOMEM;
+	}
+
+	snprintf(dev->name, IFNAMSIZ, "%s", port->name);
+
+	dev->netdev_ops = &fscc_netdev_ops;
+	dev->tx_queue_len = 100;
+
+	hdlc = dev_to_hdlc(dev);
+	hdlc->attach = fscc_netdev_attach;
+	hdlc->xmit = fscc_netdev_xmit;
+
+	SET_NETDEV_DEV(dev, port->device);
+
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(6, 1, 0)
+	netif_napi_add_weight(dev, &port->napi, fscc_netdev_poll, FSCC_NAPI_WEIGHT);
+#else
+	netif_napi_add(dev, &port->napi, fscc_netdev_poll, FSCC_NAPI_WEIGHT);
+#endif
+
+	error_code = register_hdlc_device(dev);
+
+	if (error_code < 0) {
+		dev_err(port->device, "register_hdlc_device failed\n");
+		netif_napi_del(&port->napi);
+		free_netdev(dev);
+		return error_code;
+	}
+
+#ifdef FSCC_XDP
+	/* NAPI isn't enabled until the interface is opened, so there is no id to
+	   give yet. 0 leaves the queue without one, busy polling isn't used. */
+	if (xdp_rxq_info_reg(&port->xdp_rxq, dev, 0, 0) < 0 ||
+		xdp_rxq_info_reg_mem_model(&port->xdp_rxq, MEM_TYPE_PAGE_SHARED,
+								   NULL) < 0) {
+		dev_err(port->device, "xdp_rxq_info_reg failed\n");
+		xdp_rxq_info_unreg(&port->xdp_rxq);
+		unregister_hdlc_device(dev);
+		netif_napi_del(&port->napi);
+		free_netdev(dev);
+		return -ENOMEM;
+	}
+#endif
+
+	port->netdev = dev;
+
+	return 0;
+}
+
+void fscc_netdev_remove(struct fscc_port *port)
+{
+	return_if_untrue(port);
+
+	if (!port->netdev)
+		return;
+
+	/* Closes the interface and detaches any XDP program first. */
+	unregister_hdlc_device(port->netdev);
+
+#ifdef FSCC_XDP
+	xdp_rxq_info_unreg(&port->xdp_rxq);
+#endif
+	netif_napi_del(&port->napi);
+	free_netdev(port->netdev);
+
+	port->netdev = 0;
+}
+
+unsigned fscc_netdev_is_up(struct fscc_port *port)
+{
+	return (port->netdev && port->netdev_up);
+}
+
+/* Called once a received frame has been queued. */
+void fscc_netdev_rx_schedule(struct fscc_port *port)
+{
+	if (fscc_netdev_is_up(port))
+		napi_schedule(&port->napi);
+}
+
+/* Called once sent frames have been cleared. */
+void fscc_netdev_tx_wake(struct fscc_port *port)
+{
+	if (!fscc_netdev_is_up(port) || !netif_queue_stopped(port->netdev))
+		return;
+
+	/* With nothing left in flight no later completion would wake the queue,
+	   so it is started anyway and xmit drops what doesn't fit. */
+	if (fscc_netdev_tx_has_room(port) ||
+		fscc_port_get_output_memory_usage(port) == 0)
+		netif_wake_queue(port->netdev);
+}
+
+module_param(hdlc_netdev, uint, S_IRUSR | S_IRGRP | S_IROTH);
+MODULE_PARM_DESC(hdlc_netdev, "Registers a generic HDLC network interface for each port.");
@@ -0,0 +1,63 @@
+/*
+	Copyright (C) 2014 Commtech, Inc.
+
+	This file is part of fscc-linux.
+
+	fscc-linux is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	fscc-linux is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with fscc-linux.	If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef FSCC_NETDEV_H
+#define FSCC_NETDEV_H
+
+struct fscc_port;
+
+#ifdef FSCC_HDLC
+
+#include <linux/netdevice.h> /* struct net_device, struct napi_struct */
+#include <linux/version.h> /* LINUX_VERSION_CODE, KERNEL_VERSION */
+
+#define FSCC_NAPI_WEIGHT 64
+
+/* Native XDP is written against the xdp_buff helpers from 5.12 and the
+   ndo_xdp_xmit semantics from 5.15. Older kernels still get generic XDP. */
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(5, 15, 0)
+#define FSCC_XDP
+
+#include <net/xdp.h> /* struct xdp_rxq_info */
+#include <linux/skbuff.h> /* struct skb_shared_info */
+
+/* Received frames are copied into a single page behind XDP_PACKET_HEADROOM
+   with room left for an skb to be built around them. */
+#define FSCC_XDP_MAX_FRAME (PAGE_SIZE - XDP_PACKET_HEADROOM - \
+							SKB_DATA_ALIGN(sizeof(struct skb_shared_info)))
+#endif
+
+int fscc_netdev_create(struct fscc_port *port);
+void fscc_netdev_remove(struct fscc_port *port);
+unsigned fscc_netdev_is_up(struct fscc_port *port);
+void fscc_netdev_rx_schedule(struct fscc_port *port);
+void fscc_netdev_tx_wake(struct fscc_port *port);
+
+#else
+
+static inline int fscc_netdev_create(struct fscc_port *port) { return 0; }
+static inline void fscc_netdev_remove(struct fscc_port *port) { }
+static inline unsigned fscc_netdev_is_up(struct fscc_port *port) { return 0; }
+static inline void fscc_netdev_rx_schedule(struct fscc_port *port) { }
+static inline void fscc_netdev_tx_wake(struct fscc_port *port) { }
+
+#endif /* FSCC_HDLC */
+
+#endif
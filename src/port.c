@@ -29,6 +29,7 @@
 #include "config.h" /* DEVICE_NAME, DEFAULT_* */
 #include "isr.h" /* fscc_isr */
 #include "sysfs.h" /* port_*_attribute_group */
+#include "trace.h" /* trace_fscc_* */
 
 
 void fscc_port_execute_GO_R(struct fscc_port *port);
@@ -107,6 +108,29 @@ struct fscc_port *fscc_port_new(struct fscc_card *card, unsigned channel,
 	port->interrupt_tracker = debug_interrupt_tracker_new();
 #endif
 
+	port->stats = fscc_stats_new();
+	port->latency = fscc_latency_new();
+
+	if (port->stats == NULL || port->latency == NULL) {
+		if (port->stats)
+			fscc_stats_delete(port->stats);
+
+		if (port->latency)
+			fscc_latency_delete(port->latency);
+
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(2, 6, 18)
+		device_destroy(port->class, port->dev_t);
+#endif
+
+		if (port->name)
+			kfree(port->name);
+
+		kfree(port);
+
+		printk(KERN_ERR DEVICE_NAME " alloc_percpu failed\n");
+		return 0;
+	}
+
 	port->channel = channel;
 	port->card = card;
 
@@ -114,16 +138,61 @@ struct fscc_port *fscc_port_new(struct fscc_card *card, unsigned channel,
 
 	fscc_port_set_append_status(port, DEFAULT_APPEND_STATUS_VALUE);
 	fscc_port_set_append_timestamp(port, DEFAULT_APPEND_TIMESTAMP_VALUE);
+	fscc_port_set_append_sequence(port, DEFAULT_APPEND_SEQUENCE_VALUE);
+	fscc_port_set_timestamp_clock(port, DEFAULT_TIMESTAMP_CLOCK_VALUE);
 	fscc_port_set_ignore_timeout(port, DEFAULT_IGNORE_TIMEOUT_VALUE);
 	fscc_port_set_tx_modifiers(port, DEFAULT_TX_MODIFIERS_VALUE);
 	fscc_port_set_rx_multiple(port, DEFAULT_RX_MULTIPLE_VALUE);
+	fscc_port_set_tx_reports(port, DEFAULT_TX_REPORTS_VALUE);
+	fscc_port_set_report_overflow(port, DEFAULT_REPORT_OVERFLOW_VALUE);
 
 	port->memory_cap.input = DEFAULT_INPUT_MEMORY_CAP_VALUE;
 	port->memory_cap.output = DEFAULT_OUTPUT_MEMORY_CAP_VALUE;
 
+	port->wakeup.rx_frames = DEFAULT_RX_WAKE_FRAMES_VALUE;
+	port->wakeup.rx_bytes = DEFAULT_RX_WAKE_BYTES_VALUE;
+	port->wakeup.rx_timeout = DEFAULT_RX_WAKE_TIMEOUT_VALUE;
+	port->wakeup.tx_bytes = DEFAULT_TX_WAKE_BYTES_VALUE;
+	port->rx_wake_expired = 0;
+
+	port->tx_zero_copy = DEFAULT_TX_ZERO_COPY_VALUE;
+	port->tx_zero_copy_queued = 0;
+	atomic_set(&port->tx_zero_copy_done, 0);
+
+	port->tx_cookie = 0;
+	atomic_set(&port->tx_underrun, 0);
+	memset(&port->tx_report_list, 0, sizeof(port->tx_report_list));
+
+	port->rx_filter = 0;
+	port->address_set = 0;
+
+	atomic_set(&port->budget_usage, 0);
+	port->budget_waiting = 0;
+	port->istream_usage = 0;
+
+	port->flush_timeout = DEFAULT_FLUSH_TIMEOUT_VALUE;
+	port->flush_armed = 0;
+	port->last_activity = 0;
+
+	port->input_cap_policy = DEFAULT_INPUT_CAP_POLICY_VALUE;
+	port->rx_blocked = 0;
+	port->rejected_last_frame = 0;
+	port->rejected_last_stream = 0;
+
 	port->pending_iframe = 0;
 	port->pending_oframe = 0;
 
+	port->rx_overflow = 0;
+	port->rx_overflow_frames = 0;
+	port->rx_discard = 0;
+	port->rx_discard_skip = 0;
+	port->rx_discard_reason = 0;
+	atomic_set(&port->rx_overflow_reports, 0);
+
+	port->rx_sequence = 0;
+	port->tx_sequence = 0;
+	memset(&port->rx_drops, 0, sizeof(port->rx_drops));
+
 	spin_lock_init(&port->board_settings_spinlock);
 	spin_lock_init(&port->board_rx_spinlock);
 	spin_lock_init(&port->board_tx_spinlock);
@@ -134,12 +203,18 @@ struct fscc_port *fscc_port_new(struct fscc_card *card, unsigned channel,
 	spin_lock_init(&port->sent_oframes_spinlock);
 	spin_lock_init(&port->queued_oframes_spinlock);
 	spin_lock_init(&port->queued_iframes_spinlock);
+	spin_lock_init(&port->rx_drops_spinlock);
+	spin_lock_init(&port->rx_stamps_spinlock);
+	spin_lock_init(&port->tx_reports_spinlock);
 
 	/* Simple check to see if the port is messed up. It won't catch all
 	   instances. */
 	if (fscc_port_get_PREV(port) == 0xff) {
 		dev_warn(port->device, "couldn't initialize\n");
 
+		fscc_stats_delete(port->stats);
+		fscc_latency_delete(port->latency);
+
 #if LINUX_VERSION_CODE >= KERNEL_VERSION(2, 6, 18)
 		device_destroy(port->class, port->dev_t);
 #endif
@@ -157,9 +232,7 @@ struct fscc_port *fscc_port_new(struct fscc_card *card, unsigned channel,
 	fscc_flist_init(&port->sent_oframes);
 	fscc_flist_init(&port->queued_iframes);
 
-	sema_init(&port->read_semaphore, 1);
-	sema_init(&port->write_semaphore, 1);
-	sema_init(&port->poll_semaphore, 1);
+	mutex_init(&port->write_mutex);
 
 	init_waitqueue_head(&port->input_queue);
 	init_waitqueue_head(&port->output_queue);
@@ -170,6 +243,9 @@ struct fscc_port *fscc_port_new(struct fscc_card *card, unsigned channel,
 	if (cdev_add(&port->cdev, port->dev_t, 1) < 0) {
 		dev_err(port->device, "cdev_add failed\n");
 
+		fscc_stats_delete(port->stats);
+		fscc_latency_delete(port->latency);
+
 #if LINUX_VERSION_CODE >= KERNEL_VERSION(2, 6, 18)
 		device_destroy(port->class, port->dev_t);
 #endif
@@ -183,6 +259,11 @@ struct fscc_port *fscc_port_new(struct fscc_card *card, unsigned channel,
 	}
 
 	port->last_isr_value = 0;
+	port->rx_stamps_first = 0;
+	port->rx_stamps_count = 0;
+	port->tx_isr_time = 0;
+	port->tx_isr_stamp = 0;
+	port->debugfs_dir = 0;
 
 	FSCC_REGISTERS_INIT(port->register_storage);
 
@@ -205,15 +286,20 @@ struct fscc_port *fscc_port_new(struct fscc_card *card, unsigned channel,
 
 	fscc_port_set_registers(port, &port->register_storage);
 
+	fscc_fifot_init(port);
+
 	irq_num = fscc_card_get_irq(card);
 
+	/* Emulated cards call fscc_isr themselves. */
+	if (!fscc_card_is_emulated(card)) {
 #if LINUX_VERSION_CODE >= KERNEL_VERSION(2, 6, 18)
-	if (request_irq(irq_num, &fscc_isr, IRQF_SHARED, port->name, port)) {
+		if (request_irq(irq_num, &fscc_isr, IRQF_SHARED, port->name, port)) {
 #else
-	if (request_irq(irq_num, &fscc_isr, SA_SHIRQ, port->name, port)) {
+		if (request_irq(irq_num, &fscc_isr, SA_SHIRQ, port->name, port)) {
 #endif
-		dev_err(port->device, "request_irq failed on irq %i\n", irq_num);
-		return 0;
+			dev_err(port->device, "request_irq failed on irq %i\n", irq_num);
+			goto error_irq;
+		}
 	}
 
 /* The sysfs structures I use in sysfs.c don't work prior to 2.6.25 */
@@ -247,6 +333,8 @@ struct fscc_port *fscc_port_new(struct fscc_card *card, unsigned channel,
 
 #endif /* LINUX_VERSION_CODE >= KERNEL_VERSION(2, 6, 25) */
 
+	fscc_latency_debugfs_create(port);
+
 	tasklet_init(&port->send_oframe_tasklet, oframe_worker, (unsigned long)port);
 	tasklet_init(&port->clear_oframe_tasklet, clear_oframe_worker, (unsigned long)port);
 	tasklet_init(&port->iframe_tasklet, iframe_worker, (unsigned long)port);
@@ -256,16 +344,34 @@ struct fscc_port *fscc_port_new(struct fscc_card *card, unsigned channel,
 	tasklet_init(&port->print_tasklet, debug_interrupt_display, (unsigned long)port);
 #endif
 
-	if (fscc_port_has_dma(port)) {
-		port->null_descriptor = kmalloc(sizeof(*port->null_descriptor),
-		                                GFP_ATOMIC | GFP_DMA);
+	/* Stays empty on FIFO only ports, fscc_port_delete checks for that. The
+	   pool is created even while force_fifo is set since it can be cleared
+	   once the port is running. */
+	port->descriptor_pool = 0;
+	port->null_descriptor = 0;
+
+	if (port->card->dma) {
+		/* The card writes completion status back into the descriptors, so
+		   they live in coherent memory instead of being mapped per frame. */
+		port->descriptor_pool = dma_pool_create(port->name,
+		                                        fscc_card_get_device(port->card),
+		                                        sizeof(struct fscc_descriptor),
+		                                        16, 0);
+
+		if (port->descriptor_pool == NULL) {
+			dev_err(port->device, "dma_pool_create failed\n");
+			goto error_pool;
+		}
 
-		memset(port->null_descriptor, 0, sizeof(*port->null_descriptor));
+		port->null_descriptor = dma_pool_alloc(port->descriptor_pool,
+		                                       GFP_KERNEL, &port->null_handle);
+
+		if (port->null_descriptor == NULL) {
+			dev_err(port->device, "dma_pool_alloc failed\n");
+			goto error_descriptor;
+		}
 
-		port->null_handle = pci_map_single(port->card->pci_dev,
-		                                   port->null_descriptor,
-	                                       sizeof(*port->null_descriptor),
-	                                       DMA_TO_DEVICE);
+		memset(port->null_descriptor, 0, sizeof(*port->null_descriptor));
 	}
 
 	dev_info(port->device, "%s (%x.%02x)\n", fscc_card_get_name(port->card),
@@ -273,7 +379,14 @@ struct fscc_port *fscc_port_new(struct fscc_card *card, unsigned channel,
 
 	fscc_port_set_clock_bits(port, clock_bits);
 
-	setup_timer(&port->timer, &timer_handler, (unsigned long)port);
+	hrtimer_init(&port->flush_timer, CLOCK_MONOTONIC, HRTIMER_MODE_REL);
+	port->flush_timer.function = &flush_timer_handler;
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(4, 15, 0)
+	timer_setup(&port->rx_wake_timer, &rx_wake_timer_handler, 0);
+#else
+	setup_timer(&port->rx_wake_timer, &rx_wake_timer_handler,
+				(unsigned long)port);
+#endif
 
 	if (fscc_port_has_dma(port)) {
 		fscc_port_execute_RST_R(port);
@@ -283,7 +396,43 @@ struct fscc_port *fscc_port_new(struct fscc_card *card, unsigned channel,
 	fscc_port_execute_RRES(port);
 	fscc_port_execute_TRES(port);
 
+	fscc_budget_add_port(port);
+
+	if (fscc_netdev_create(port) < 0)
+		dev_warn(port->device, "network interface not registered\n");
+
 	return port;
+
+error_descriptor:
+	dma_pool_destroy(port->descriptor_pool);
+
+error_pool:
+	fscc_latency_debugfs_remove(port);
+
+	if (!fscc_card_is_emulated(card))
+		free_irq(irq_num, port);
+
+error_irq:
+	cdev_del(&port->cdev);
+	fscc_frame_delete(port->istream);
+
+	fscc_stats_delete(port->stats);
+	fscc_latency_delete(port->latency);
+
+#ifdef DEBUG
+	debug_interrupt_tracker_delete(port->interrupt_tracker);
+#endif
+
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(2, 6, 18)
+	device_destroy(port->class, port->dev_t);
+#endif
+
+	if (port->name)
+		kfree(port->name);
+
+	kfree(port);
+
+	return 0;
 }
 
 void fscc_port_delete(struct fscc_port *port)
@@ -296,13 +445,23 @@ void fscc_port_delete(struct fscc_port *port)
 
 	return_if_untrue(port);
 
+	fscc_netdev_remove(port);
+	fscc_budget_remove_port(port);
+
 	/* Stops the the timer and transmit repeat abailities if they are on. */
 	fscc_port_set_register(port, 0, CMDR_OFFSET, 0x04000002);
 
-	del_timer(&port->timer);
+	if (!fscc_card_is_emulated(port->card)) {
+		irq_num = fscc_card_get_irq(port->card);
+		free_irq(irq_num, port);
+	}
+
+	fscc_fifot_stop(port);
+	del_timer_sync(&port->rx_wake_timer);
 
-	irq_num = fscc_card_get_irq(port->card);
-	free_irq(irq_num, port);
+	/* The interrupt handler re-arms the flush timer, so it can only be
+	   cancelled for good once the handler is gone. */
+	hrtimer_cancel(&port->flush_timer);
 
 	if (fscc_port_has_dma(port)) {
 		fscc_port_execute_STOP_T(port);
@@ -312,15 +471,18 @@ void fscc_port_delete(struct fscc_port *port)
 
 		fscc_port_set_register(port, 2, DMACCR_OFFSET, 0x00000000);
 		fscc_port_set_register(port, 2, DMA_TX_BASE_OFFSET, 0x00000000);
-
-		pci_unmap_single(port->card->pci_dev, port->null_handle,
-						 sizeof(*port->null_descriptor), DMA_TO_DEVICE);
-
-		kfree(port->null_descriptor);
 	}
 
+	/* force_fifo can change after the port was created, so the pool itself
+	   says whether DMA was set up. */
+	if (port->descriptor_pool && port->null_descriptor)
+		dma_pool_free(port->descriptor_pool, port->null_descriptor,
+		              port->null_handle);
+
 	spin_lock_irqsave(&port->istream_spinlock, stream_flags);
 	fscc_frame_delete(port->istream);
+	fscc_budget_charge(port, -(int)port->istream_usage);
+	port->istream_usage = 0;
 	spin_unlock_irqrestore(&port->istream_spinlock, stream_flags);
 
 	spin_lock_irqsave(&port->queued_iframes_spinlock, queued_iframes_flags);
@@ -335,6 +497,17 @@ void fscc_port_delete(struct fscc_port *port)
 	fscc_flist_delete(&port->sent_oframes);
 	spin_unlock_irqrestore(&port->sent_oframes_spinlock, sent_oframes_flags);
 
+	fscc_filter_delete(port->rx_filter);
+	fscc_address_set_delete(port->address_set);
+
+	/* Every descriptor has been returned now that the frames are gone. */
+	if (port->descriptor_pool)
+		dma_pool_destroy(port->descriptor_pool);
+
+	fscc_latency_debugfs_remove(port);
+	fscc_latency_delete(port->latency);
+	fscc_stats_delete(port->stats);
+
 #ifdef DEBUG
 	debug_interrupt_tracker_delete(port->interrupt_tracker);
 #endif
@@ -351,10 +524,217 @@ void fscc_port_delete(struct fscc_port *port)
 	kfree(port);
 }
 
-void fscc_port_reset_timer(struct fscc_port *port)
+/*
+	Called on every interrupt. Only records the time unless the flush timer is
+	idle, so the common case doesn't touch the timer at all.
+*/
+void fscc_port_kick_flush_timer(struct fscc_port *port)
+{
+	port->last_activity = fscc_latency_now();
+	smp_mb();
+
+	if (test_and_set_bit(0, &port->flush_armed))
+		return;
+
+	hrtimer_start(&port->flush_timer,
+				  ns_to_ktime((__u64)port->flush_timeout * NSEC_PER_USEC),
+				  HRTIMER_MODE_REL);
+}
+
+/* Returns -EINVAL if the timeout is below FSCC_MIN_FLUSH_TIMEOUT */
+int fscc_port_set_flush_timeout(struct fscc_port *port, unsigned value)
+{
+	return_val_if_untrue(port, 0);
+
+	if (value < FSCC_MIN_FLUSH_TIMEOUT) {
+		dev_warn(port->device, "flush timeout (invalid value %i)\n", value);
+		return -EINVAL;
+	}
+
+	if (port->flush_timeout != value) {
+		dev_dbg(port->device, "flush timeout %i => %i\n",
+				port->flush_timeout, value);
+	}
+	else {
+		dev_dbg(port->device, "flush timeout %i\n", value);
+	}
+
+	port->flush_timeout = value;
+
+	return 1;
+}
+
+int fscc_port_set_tx_zero_copy(struct fscc_port *port, unsigned value)
+{
+	return_val_if_untrue(port, 0);
+
+	if (value && !fscc_port_has_dma(port)) {
+		dev_warn(port->device, "tx zero copy (requires dma)\n");
+		return -EOPNOTSUPP;
+	}
+
+	if (port->tx_zero_copy != value) {
+		dev_dbg(port->device, "tx zero copy %i => %i\n",
+				port->tx_zero_copy, value);
+	}
+	else {
+		dev_dbg(port->device, "tx zero copy %i\n", value);
+	}
+
+	port->tx_zero_copy = value;
+
+	return 1;
+}
+
+/*
+	Replaces the receive filter, a null program removes it. Returns -EINVAL if
+	the program doesn't pass the checks in fscc_filter_new.
+*/
+int fscc_port_set_rx_filter(struct fscc_port *port,
+							const struct sock_fprog *fprog)
+{
+	struct fscc_filter *filter = 0;
+	struct fscc_filter *old_filter = 0;
+	unsigned long frame_flags = 0;
+	int error_code = 0;
+
+	return_val_if_untrue(port, 0);
+
+	if (fprog) {
+		filter = fscc_filter_new(fprog, &error_code);
+
+		if (!filter) {
+			if (error_code == -EINVAL)
+				dev_warn(port->device, "invalid receive filter\n");
+
+			return error_code;
+		}
+	}
+
+	spin_lock_irqsave(&port->pending_iframe_spinlock, frame_flags);
+	old_filter = port->rx_filter;
+	port->rx_filter = filter;
+	spin_unlock_irqrestore(&port->pending_iframe_spinlock, frame_flags);
+
+	dev_dbg(port->device, "rx_filter %i => %i instructions\n",
+			(old_filter) ? old_filter->length : 0,
+			(filter) ? filter->length : 0);
+
+	fscc_filter_delete(old_filter);
+
+	return 0;
+}
+
+/*
+	Replaces the receive address set, a null filter removes it. The card's
+	own address registers and CCR0 address mode are saved when a set is first
+	applied and put back once it is removed. Returns -EINVAL if the set is empty, too large or an
+	address doesn't fit in the width.
+*/
+int fscc_port_set_address_filter(struct fscc_port *port,
+								 const struct fscc_address_filter *filter)
+{
+	struct fscc_address_set *set = 0;
+	struct fscc_address_set *old_set = 0;
+	unsigned long board_flags = 0;
+	unsigned long frame_flags = 0;
+	int error_code = 0;
+
+	return_val_if_untrue(port, 0);
+
+	if (filter) {
+		set = fscc_address_set_new(filter, &error_code);
+
+		if (!set) {
+			if (error_code == -EINVAL)
+				dev_warn(port->device, "invalid address filter\n");
+
+			return error_code;
+		}
+	}
+
+	spin_lock_irqsave(&port->board_settings_spinlock, board_flags);
+	spin_lock_irqsave(&port->pending_iframe_spinlock, frame_flags);
+
+	old_set = port->address_set;
+	port->address_set = set;
+
+	spin_unlock_irqrestore(&port->pending_iframe_spinlock, frame_flags);
+
+	if (set && !old_set) {
+		port->address_rar = port->register_storage.RAR;
+		port->address_ramr = port->register_storage.RAMR;
+		port->address_ccr0 = port->register_storage.CCR0;
+	}
+
+	/* The card only compares addresses with address mode on in CCR0. */
+	if (set) {
+		__u32 ccr0 = port->register_storage.CCR0 & ~CCR0_ADM_MASK;
+
+		ccr0 |= (set->settings.width == 2) ? CCR0_ADM_16_BIT : CCR0_ADM_8_BIT;
+
+		fscc_port_set_register(port, 0, RAR_OFFSET, set->rar);
+		fscc_port_set_register(port, 0, RAMR_OFFSET, set->ramr);
+		fscc_port_set_register(port, 0, CCR0_OFFSET, ccr0);
+	}
+	else if (old_set) {
+		fscc_port_set_register(port, 0, RAR_OFFSET, port->address_rar);
+		fscc_port_set_register(port, 0, RAMR_OFFSET, port->address_ramr);
+		fscc_port_set_register(port, 0, CCR0_OFFSET,
+							   (port->register_storage.CCR0 & ~CCR0_ADM_MASK) |
+							   (port->address_ccr0 & CCR0_ADM_MASK));
+	}
+
+	spin_unlock_irqrestore(&port->board_settings_spinlock, board_flags);
+
+	dev_dbg(port->device, "address_filter %i => %i addresses\n",
+			(old_set) ? old_set->settings.count : 0,
+			(set) ? set->settings.count : 0);
+
+	fscc_address_set_delete(old_set);
+
+	return 0;
+}
+
+/* A width of 0 means there is no address filter. */
+void fscc_port_get_address_filter(struct fscc_port *port,
+								  struct fscc_address_filter *filter)
+{
+	unsigned long frame_flags = 0;
+
+	return_if_untrue(port);
+
+	memset(filter, 0, sizeof(*filter));
+
+	spin_lock_irqsave(&port->pending_iframe_spinlock, frame_flags);
+
+	if (port->address_set)
+		memcpy(filter, &port->address_set->settings, sizeof(*filter));
+
+	spin_unlock_irqrestore(&port->pending_iframe_spinlock, frame_flags);
+}
+
+unsigned fscc_port_get_tx_zero_copy(struct fscc_port *port)
 {
-	if (mod_timer(&port->timer, jiffies + msecs_to_jiffies(250)))
-		dev_err(port->device, "mod_timer\n");
+	return_val_if_untrue(port, 0);
+
+	return port->tx_zero_copy;
+}
+
+/* Whether a write of length bytes is sent straight from the user's pages. */
+unsigned fscc_port_uses_zero_copy(struct fscc_port *port, unsigned length)
+{
+	return_val_if_untrue(port, 0);
+
+	return port->tx_zero_copy && length >= port->tx_zero_copy &&
+	       fscc_port_has_dma(port);
+}
+
+unsigned fscc_port_get_flush_timeout(struct fscc_port *port)
+{
+	return_val_if_untrue(port, 0);
+
+	return port->flush_timeout;
 }
 
 /* Basic check to see if the CE bit is set. */
@@ -375,11 +755,14 @@ unsigned fscc_port_timed_out(struct fscc_port *port)
 	return 1;
 }
 
-/* Create the data structures the work horse functions use to send data. */
-int fscc_port_write(struct fscc_port *port, const char *data, unsigned length)
+/*
+	Create the data structures the work horse functions use to send data.
+	With zero_copy set the frame is sent straight from the user's pages.
+*/
+int fscc_port_write(struct fscc_port *port, const char *data, unsigned length,
+					unsigned zero_copy)
 {
 	struct fscc_frame *frame = 0;
-	unsigned long queued_flags = 0;
 
 	return_val_if_untrue(port, 0);
 
@@ -394,15 +777,101 @@ int fscc_port_write(struct fscc_port *port, const char *data, unsigned length)
 	if (!frame)
 		return -ENOMEM;
 
-	fscc_frame_add_data_from_user(frame, data, length);
+	if (zero_copy) {
+		if (!fscc_frame_add_user_pages(frame, data, length)) {
+			fscc_frame_delete(frame);
+			return -EFAULT;
+		}
+
+		frame->zero_copy_sequence = ++port->tx_zero_copy_queued;
+	}
+	else {
+		fscc_frame_add_data_from_user(frame, data, length);
+	}
+
+	if (port->tx_reports) {
+		frame->tx_report = 1;
+		frame->cookie = port->tx_cookie++;
+	}
+
+	fscc_port_queue_frame(port, frame);
+
+	return 0;
+}
+
+/* Hands a filled frame to the transmit path. */
+void fscc_port_queue_frame(struct fscc_port *port, struct fscc_frame *frame)
+{
+	unsigned long queued_flags = 0;
+
+	frame->queued_time = fscc_latency_now();
 
 	spin_lock_irqsave(&port->queued_oframes_spinlock, queued_flags);
+	frame->number = port->tx_sequence++;
+
+	trace_fscc_tx_enqueue(port, frame);
+
 	fscc_flist_add_frame(&port->queued_oframes, frame);
 	spin_unlock_irqrestore(&port->queued_oframes_spinlock, queued_flags);
 
 	tasklet_schedule(&port->send_oframe_tasklet);
+}
 
-	return 0;
+/*
+	Waits until the card is done reading the user pages behind zero copy
+	frame number sequence. Only fatal signals interrupt, the pages are pinned
+	until then either way.
+*/
+void fscc_port_wait_zero_copy(struct fscc_port *port, unsigned sequence)
+{
+	wait_event_killable(port->output_queue,
+	                    (int)(atomic_read(&port->tx_zero_copy_done) - sequence) >= 0);
+}
+
+/* Zero copy frames whose user pages are still pinned. */
+unsigned fscc_port_get_zero_copy_in_flight(struct fscc_port *port)
+{
+	return_val_if_untrue(port, 0);
+
+	return port->tx_zero_copy_queued - atomic_read(&port->tx_zero_copy_done);
+}
+
+/*
+	Copies data_length bytes of the frame to the user followed by whatever is
+	appended to it. The data is only taken out of the frame once everything
+	else has been copied, so on -EFAULT the frame is left untouched.
+*/
+static int copy_frame_to_user(struct fscc_port *port, struct fscc_frame *frame,
+							  char *buf, unsigned data_length)
+{
+	unsigned length = data_length;
+
+	if (port->append_timestamp) {
+		unsigned timestamp_length = fscc_frame_get_timestamp_length(frame);
+		void *timestamp = 0;
+
+		if (frame->timestamp_clock == FSCC_TIMESTAMP_LEGACY)
+			timestamp = &frame->timestamp;
+		else
+			timestamp = &frame->timestamp_ns;
+
+		if (copy_to_user(buf + length, timestamp, timestamp_length))
+			return -EFAULT;
+
+		length += timestamp_length;
+	}
+
+	if (port->append_sequence) {
+		if (copy_to_user(buf + length, &frame->number, sizeof(frame->number)))
+			return -EFAULT;
+
+		length += sizeof(frame->number);
+	}
+
+	if (!fscc_frame_remove_data(frame, buf, data_length))
+		return -EFAULT;
+
+	return length;
 }
 
 /*
@@ -417,26 +886,33 @@ ssize_t fscc_port_frame_read(struct fscc_port *port, char *buf, size_t buf_lengt
 	unsigned current_frame_length = 0;
 	unsigned out_length = 0;
 	unsigned long queued_flags = 0;
+	int copied_length = 0;
+	int error_code = 0;
 
 	return_val_if_untrue(port, 0);
 
 	do {
 		remaining_buf_length = buf_length - out_length;
 
-		if (port->append_status && port->append_timestamp)
-			max_frame_length = remaining_buf_length - sizeof(fscc_timestamp);
-		else if (port->append_status)
+		spin_lock_irqsave(&port->queued_iframes_spinlock, queued_flags);
+
+		/* The status bytes are part of the frame, the timestamp and sequence
+		   number come after it. The timestamp's size depends on the clock
+		   the frame was stamped with, not the one selected now. */
+		frame = fscc_flist_peek_front(&port->queued_iframes);
+
+		if (frame) {
 			max_frame_length = remaining_buf_length;
-		else if (port->append_timestamp)
-			max_frame_length = remaining_buf_length + 2 - sizeof(fscc_timestamp);
-		else
-			max_frame_length = remaining_buf_length + 2; // Status length
+			max_frame_length += (!port->append_status) ? STATUS_LENGTH : 0;
+			max_frame_length -= (port->append_timestamp) ? fscc_frame_get_timestamp_length(frame) : 0;
+			max_frame_length -= (port->append_sequence) ? sizeof(__u32) : 0;
 
-		if (max_frame_length < 0)
-			break;
+			if (max_frame_length >= 0)
+				frame = fscc_flist_remove_frame_if_lte(&port->queued_iframes, max_frame_length);
+			else
+				frame = 0;
+		}
 
-		spin_lock_irqsave(&port->queued_iframes_spinlock, queued_flags);
-		frame = fscc_flist_remove_frame_if_lte(&port->queued_iframes, max_frame_length);
 		spin_unlock_irqrestore(&port->queued_iframes_spinlock, queued_flags);
 
 		if (!frame)
@@ -445,21 +921,46 @@ ssize_t fscc_port_frame_read(struct fscc_port *port, char *buf, size_t buf_lengt
 		current_frame_length = fscc_frame_get_length(frame);
 		current_frame_length -= (!port->append_status) ? 2 : 0;
 
-		fscc_frame_remove_data(frame, buf + out_length, current_frame_length);
-		out_length += current_frame_length;
+		copied_length = copy_frame_to_user(port, frame, buf + out_length,
+										   current_frame_length);
+
+		/* The frame is still whole, so it goes back to the front of the queue
+		   for the next read. */
+		if (copied_length < 0) {
+			spin_lock_irqsave(&port->queued_iframes_spinlock, queued_flags);
+			fscc_flist_add_frame_front(&port->queued_iframes, frame);
+			spin_unlock_irqrestore(&port->queued_iframes_spinlock, queued_flags);
+
+			error_code = copied_length;
+			break;
+		}
+
+		out_length += copied_length;
 
-		if (port->append_timestamp) {
-			memcpy(buf + out_length, &frame->timestamp, sizeof(frame->timestamp));
-			current_frame_length += sizeof(frame->timestamp);
-			out_length += sizeof(frame->timestamp);
+		{
+			__u64 now = fscc_latency_now();
+
+			fscc_latency_record(port->latency, FSCC_LATENCY_RX_QUEUE_TO_USER,
+								frame->queued_time, now);
+			fscc_latency_record(port->latency, FSCC_LATENCY_RX_TOTAL,
+								frame->isr_time, now);
 		}
 
 		fscc_frame_delete(frame);
 	}
 	while (port->rx_multiple);
 
+	fscc_port_unblock_rx(port);
+	fscc_budget_release(port);
+
+	/* Frames already copied are returned, the failure shows up on the next
+	   read. */
+	if (error_code < 0 && out_length == 0)
+		return error_code;
+
+	/* Another reader may have emptied the queue first. */
 	if (out_length == 0)
-		return -ENOBUFS;
+		return fscc_port_has_incoming_data(port) ? -ENOBUFS : 0;
 
 	return out_length;
 }
@@ -482,8 +983,17 @@ ssize_t fscc_port_stream_read(struct fscc_port *port, char *buf,
 
 	fscc_frame_remove_data(port->istream, buf, out_length);
 
+	/* Release the buffer so an idle stream doesn't hold on to memory. */
+	if (fscc_frame_is_empty(port->istream))
+		fscc_frame_clear(port->istream);
+
+	fscc_port_charge_istream(port);
+
 	spin_unlock_irqrestore(&port->istream_spinlock, flags);
 
+	fscc_port_unblock_rx(port);
+	fscc_budget_release(port);
+
 	return out_length;
 }
 
@@ -493,10 +1003,19 @@ ssize_t fscc_port_stream_read(struct fscc_port *port, char *buf,
 */
 ssize_t fscc_port_read(struct fscc_port *port, char *buf, size_t count)
 {
+	ssize_t read_count = 0;
+
 	if (fscc_port_is_streaming(port))
-		return fscc_port_stream_read(port, buf, count);
+		read_count = fscc_port_stream_read(port, buf, count);
 	else
-		return fscc_port_frame_read(port, buf, count);
+		read_count = fscc_port_frame_read(port, buf, count);
+
+	/* Whatever is left starts waiting from now. */
+	port->rx_wake_expired = 0;
+	del_timer(&port->rx_wake_timer);
+	fscc_port_wake_readers(port);
+
+	return read_count;
 }
 
 /* Count is for streaming mode where we need to check there is enough
@@ -812,6 +1331,7 @@ int fscc_port_purge_rx(struct fscc_port *port)
 
 	spin_lock_irqsave(&port->istream_spinlock, istream_flags);
 	fscc_frame_clear(port->istream);
+	fscc_port_charge_istream(port);
 	spin_unlock_irqrestore(&port->istream_spinlock, istream_flags);
 
 	spin_lock_irqsave(&port->pending_iframe_spinlock, pending_flags);
@@ -819,8 +1339,20 @@ int fscc_port_purge_rx(struct fscc_port *port)
 		fscc_frame_delete(port->pending_iframe);
 		port->pending_iframe = 0;
 	}
+
+	port->rx_overflow = 0;
+	port->rx_discard = 0;
 	spin_unlock_irqrestore(&port->pending_iframe_spinlock, pending_flags);
 
+	atomic_set(&port->rx_overflow_reports, 0);
+
+	port->rx_blocked = 0;
+
+	del_timer(&port->rx_wake_timer);
+	port->rx_wake_expired = 0;
+
+	fscc_budget_release(port);
+
 	return 1;
 }
 
@@ -859,6 +1391,7 @@ int fscc_port_purge_tx(struct fscc_port *port)
 	spin_unlock_irqrestore(&port->pending_oframe_spinlock, pending_flags);
 
 	wake_up_interruptible(&port->output_queue);
+	fscc_budget_release(port);
 
 	return 1;
 }
@@ -873,16 +1406,16 @@ unsigned fscc_port_get_input_memory_usage(struct fscc_port *port)
 	return_val_if_untrue(port, 0);
 
 	spin_lock_irqsave(&port->queued_iframes_spinlock, queued_flags);
-	value = port->queued_iframes.estimated_memory_usage;
+	value = port->queued_iframes.memory_usage;
 	spin_unlock_irqrestore(&port->queued_iframes_spinlock, queued_flags);
 
 	spin_lock_irqsave(&port->istream_spinlock, stream_flags);
-	value += fscc_frame_get_length(port->istream);
+	value += fscc_frame_get_memory_usage(port->istream);
 	spin_unlock_irqrestore(&port->istream_spinlock, stream_flags);
 
 	spin_lock_irqsave(&port->pending_iframe_spinlock, pending_flags);
 	if (port->pending_iframe)
-		value += fscc_frame_get_length(port->pending_iframe);
+		value += fscc_frame_get_memory_usage(port->pending_iframe);
 	spin_unlock_irqrestore(&port->pending_iframe_spinlock, pending_flags);
 
 	return value;
@@ -893,16 +1426,22 @@ unsigned fscc_port_get_output_memory_usage(struct fscc_port *port)
 	unsigned value = 0;
 	unsigned long pending_flags;
 	unsigned long queued_flags;
+	unsigned long sent_flags;
 
 	return_val_if_untrue(port, 0);
 
 	spin_lock_irqsave(&port->queued_oframes_spinlock, queued_flags);
-	value = port->queued_oframes.estimated_memory_usage;
+	value = port->queued_oframes.memory_usage;
 	spin_unlock_irqrestore(&port->queued_oframes_spinlock, queued_flags);
 
+	/* Frames stay around until the card is done with them. */
+	spin_lock_irqsave(&port->sent_oframes_spinlock, sent_flags);
+	value += port->sent_oframes.memory_usage;
+	spin_unlock_irqrestore(&port->sent_oframes_spinlock, sent_flags);
+
 	spin_lock_irqsave(&port->pending_oframe_spinlock, pending_flags);
 	if (port->pending_oframe)
-		value += fscc_frame_get_length(port->pending_oframe);
+		value += fscc_frame_get_memory_usage(port->pending_oframe);
 	spin_unlock_irqrestore(&port->pending_oframe_spinlock, pending_flags);
 
 	return value;
@@ -962,11 +1501,63 @@ unsigned fscc_port_get_output_memory_cap(struct fscc_port *port)
 	return port->memory_cap.output;
 }
 
-void fscc_port_set_memory_cap(struct fscc_port *port,
-							  struct fscc_memory_cap *value)
+/*
+	The memory caps lowered to what the driver wide budget still allows. Can't
+	be called while holding any of the port's frame locks.
+*/
+unsigned fscc_port_get_input_memory_limit(struct fscc_port *port)
 {
-	return_if_untrue(port);
-	return_if_untrue(value);
+	unsigned cap = 0;
+	unsigned room = 0;
+	unsigned usage = 0;
+
+	return_val_if_untrue(port, 0);
+
+	cap = fscc_port_get_input_memory_cap(port);
+	room = fscc_budget_get_room(port);
+
+	if (room == UINT_MAX)
+		return cap;
+
+	usage = fscc_port_get_input_memory_usage(port);
+
+	if (usage < cap && room < cap - usage) {
+		fscc_budget_wait(port);
+		return usage + room;
+	}
+
+	return cap;
+}
+
+unsigned fscc_port_get_output_memory_limit(struct fscc_port *port)
+{
+	unsigned cap = 0;
+	unsigned room = 0;
+	unsigned usage = 0;
+
+	return_val_if_untrue(port, 0);
+
+	cap = fscc_port_get_output_memory_cap(port);
+	room = fscc_budget_get_room(port);
+
+	if (room == UINT_MAX)
+		return cap;
+
+	usage = fscc_port_get_output_memory_usage(port);
+
+	if (usage < cap && room < cap - usage) {
+		fscc_budget_wait(port);
+		return usage + room;
+	}
+
+	return cap;
+}
+
+void fscc_port_set_memory_cap(struct fscc_port *port,
+							  struct fscc_memory_cap *value)
+{
+	return_if_untrue(port);
+	return_if_untrue(value);
 
 	if (value->input >= 0) {
 		if (port->memory_cap.input != value->input) {
@@ -979,6 +1570,8 @@ void fscc_port_set_memory_cap(struct fscc_port *port,
 		}
 
 		port->memory_cap.input = value->input;
+
+		fscc_port_unblock_rx(port);
 	}
 
 	if (value->output >= 0) {
@@ -995,6 +1588,457 @@ void fscc_port_set_memory_cap(struct fscc_port *port,
 	}
 }
 
+/* Negative values are left unchanged. */
+void fscc_port_set_wakeup(struct fscc_port *port, struct fscc_wakeup *value)
+{
+	return_if_untrue(port);
+	return_if_untrue(value);
+
+	if (value->rx_frames >= 0) {
+		dev_dbg(port->device, "rx wake frames %i => %i\n",
+				port->wakeup.rx_frames, value->rx_frames);
+
+		port->wakeup.rx_frames = value->rx_frames;
+	}
+
+	if (value->rx_bytes >= 0) {
+		dev_dbg(port->device, "rx wake bytes %i => %i\n",
+				port->wakeup.rx_bytes, value->rx_bytes);
+
+		port->wakeup.rx_bytes = value->rx_bytes;
+	}
+
+	if (value->rx_timeout >= 0) {
+		dev_dbg(port->device, "rx wake timeout %i => %i\n",
+				port->wakeup.rx_timeout, value->rx_timeout);
+
+		port->wakeup.rx_timeout = value->rx_timeout;
+	}
+
+	if (value->tx_bytes >= 0) {
+		dev_dbg(port->device, "tx wake bytes %i => %i\n",
+				port->wakeup.tx_bytes, value->tx_bytes);
+
+		port->wakeup.tx_bytes = value->tx_bytes;
+	}
+
+	/* Lowered thresholds might already be met. */
+	fscc_port_wake_readers(port);
+	wake_up_interruptible(&port->output_queue);
+}
+
+void fscc_port_get_wakeup(struct fscc_port *port, struct fscc_wakeup *value)
+{
+	return_if_untrue(port);
+	return_if_untrue(value);
+
+	*value = port->wakeup;
+}
+
+/*
+	Works like SO_RCVLOWAT. Readers are woken once rx_frames frames or
+	rx_bytes bytes are queued (0 ignores that threshold), once the data has
+	waited rx_timeout milliseconds or once the memory cap stops more data
+	from arriving.
+*/
+unsigned fscc_port_rx_wake_ready(struct fscc_port *port)
+{
+	unsigned long flags = 0;
+	unsigned frames = 0;
+	unsigned bytes = 0;
+
+	return_val_if_untrue(port, 0);
+
+	if (!fscc_port_has_incoming_data(port))
+		return 0;
+
+	if (port->rx_wake_expired || port->rx_blocked)
+		return 1;
+
+	if (fscc_port_is_streaming(port)) {
+		if (port->rejected_last_stream)
+			return 1;
+
+		spin_lock_irqsave(&port->istream_spinlock, flags);
+		bytes = fscc_frame_get_length(port->istream);
+		spin_unlock_irqrestore(&port->istream_spinlock, flags);
+
+		return (port->wakeup.rx_bytes <= 0 || bytes >= port->wakeup.rx_bytes);
+	}
+
+	if (port->rejected_last_frame)
+		return 1;
+
+	if (port->wakeup.rx_frames <= 0 && port->wakeup.rx_bytes <= 0)
+		return 1;
+
+	spin_lock_irqsave(&port->queued_iframes_spinlock, flags);
+	frames = fscc_flist_length(&port->queued_iframes);
+	bytes = fscc_flist_get_data_length(&port->queued_iframes);
+	spin_unlock_irqrestore(&port->queued_iframes_spinlock, flags);
+
+	if (port->wakeup.rx_frames > 0 && frames >= port->wakeup.rx_frames)
+		return 1;
+
+	if (port->wakeup.rx_bytes > 0 && bytes >= port->wakeup.rx_bytes)
+		return 1;
+
+	return 0;
+}
+
+/*
+	Works like SO_SNDLOWAT. Writers are woken once tx_bytes of output room is
+	free (or everything has been sent).
+*/
+unsigned fscc_port_tx_wake_ready(struct fscc_port *port)
+{
+	unsigned usage = 0;
+	unsigned limit = 0;
+	unsigned threshold = 0;
+
+	return_val_if_untrue(port, 0);
+
+	usage = fscc_port_get_output_memory_usage(port);
+	limit = fscc_port_get_output_memory_limit(port);
+
+	if (usage >= limit)
+		return 0;
+
+	threshold = (port->wakeup.tx_bytes > 0) ? port->wakeup.tx_bytes : 1;
+
+	return (usage == 0 || limit - usage >= threshold);
+}
+
+/* Can't be called while holding any of the port's frame locks. */
+void fscc_port_wake_readers(struct fscc_port *port)
+{
+	return_if_untrue(port);
+
+	if (fscc_port_rx_wake_ready(port)) {
+		wake_up_interruptible(&port->input_queue);
+		return;
+	}
+
+	if (port->wakeup.rx_timeout > 0 && fscc_port_has_incoming_data(port) &&
+		!timer_pending(&port->rx_wake_timer)) {
+		mod_timer(&port->rx_wake_timer,
+				  jiffies + msecs_to_jiffies(port->wakeup.rx_timeout));
+	}
+}
+
+/* Can't be called while holding any of the port's frame locks. */
+void fscc_port_wake_writers(struct fscc_port *port)
+{
+	return_if_untrue(port);
+
+	if (port->wakeup.tx_bytes <= 0 || fscc_port_tx_wake_ready(port))
+		wake_up_interruptible(&port->output_queue);
+
+	fscc_netdev_tx_wake(port);
+}
+
+/* Returns -EINVAL if you set an unknown policy */
+int fscc_port_set_input_cap_policy(struct fscc_port *port, unsigned value)
+{
+	return_val_if_untrue(port, 0);
+
+	switch (value) {
+	case FSCC_CAP_DROP_NEWEST:
+	case FSCC_CAP_DROP_OLDEST:
+	case FSCC_CAP_BLOCK:
+		break;
+
+	default:
+		dev_warn(port->device, "input cap policy (invalid value %i)\n",
+				 value);
+
+		return -EINVAL;
+	}
+
+	if (port->input_cap_policy != value) {
+		dev_dbg(port->device, "input cap policy %i => %i\n",
+				port->input_cap_policy, value);
+	}
+	else {
+		dev_dbg(port->device, "input cap policy %i\n", value);
+	}
+
+	port->input_cap_policy = value;
+
+	fscc_port_unblock_rx(port);
+
+	return 1;
+}
+
+unsigned fscc_port_get_input_cap_policy(struct fscc_port *port)
+{
+	return_val_if_untrue(port, 0);
+
+	return port->input_cap_policy;
+}
+
+/*
+	Removes frames from the front of the input queue until at least length
+	bytes have been freed (or the queue is empty). Returns the number of bytes
+	freed. The reason is either FSCC_DROP_EVICTED (input cap policy) or
+	FSCC_DROP_RECLAIMED (memory pressure).
+*/
+unsigned fscc_port_evict_iframes(struct fscc_port *port, unsigned length,
+								 unsigned reason)
+{
+	struct fscc_frame *frame = 0;
+	unsigned long queued_flags = 0;
+	unsigned freed = 0;
+
+	return_val_if_untrue(port, 0);
+
+	spin_lock_irqsave(&port->queued_iframes_spinlock, queued_flags);
+
+	while (freed < length) {
+		frame = fscc_flist_remove_frame(&port->queued_iframes);
+
+		if (!frame)
+			break;
+
+		freed += frame->memory_usage;
+
+		fscc_stats_inc(port, rx_dropped);
+
+		if (reason == FSCC_DROP_RECLAIMED)
+			fscc_stats_inc(port, rx_reclaimed);
+		else
+			fscc_stats_inc(port, rx_cap_dropped_oldest);
+
+		trace_fscc_rx_drop(port, frame, fscc_frame_get_length(frame), reason);
+		fscc_port_add_rx_drop(port, frame->number, reason);
+
+		fscc_frame_delete(frame);
+	}
+
+	spin_unlock_irqrestore(&port->queued_iframes_spinlock, queued_flags);
+
+	return freed;
+}
+
+/*
+	Reports that the frame with this sequence number was lost. Consecutive
+	losses for the same reason are merged into one range and the oldest range
+	is overwritten once there is no room left.
+*/
+void fscc_port_add_rx_drop(struct fscc_port *port, __u32 sequence,
+						   unsigned reason)
+{
+	struct fscc_rx_drops *drops = 0;
+	struct fscc_rx_drop *last = 0;
+	unsigned long drops_flags = 0;
+
+	return_if_untrue(port);
+
+	spin_lock_irqsave(&port->rx_drops_spinlock, drops_flags);
+
+	drops = &port->rx_drops;
+
+	if (drops->count)
+		last = &drops->ranges[drops->count - 1];
+
+	if (last && last->reason == reason &&
+		last->first + last->count == sequence) {
+		last->count++;
+	}
+	else {
+		if (drops->count == FSCC_MAX_RX_DROPS) {
+			memmove(&drops->ranges[0], &drops->ranges[1],
+					sizeof(drops->ranges[0]) * (FSCC_MAX_RX_DROPS - 1));
+			drops->count--;
+			drops->overwritten++;
+		}
+
+		drops->ranges[drops->count].first = sequence;
+		drops->ranges[drops->count].count = 1;
+		drops->ranges[drops->count].reason = reason;
+		drops->count++;
+	}
+
+	spin_unlock_irqrestore(&port->rx_drops_spinlock, drops_flags);
+}
+
+/*
+	Records the time of an RFE interrupt. Once the ring is full the oldest
+	stamp is overwritten, it belongs to a frame the worker fell behind on.
+*/
+void fscc_port_add_rx_stamp(struct fscc_port *port, __u64 time, __u64 stamp,
+							unsigned clock)
+{
+	struct fscc_rx_stamp *entry = 0;
+	unsigned long stamps_flags = 0;
+
+	return_if_untrue(port);
+
+	spin_lock_irqsave(&port->rx_stamps_spinlock, stamps_flags);
+
+	if (port->rx_stamps_count == RX_STAMP_RING_SIZE) {
+		port->rx_stamps_first = (port->rx_stamps_first + 1) % RX_STAMP_RING_SIZE;
+		port->rx_stamps_count--;
+	}
+
+	entry = &port->rx_stamps[(port->rx_stamps_first + port->rx_stamps_count) %
+							 RX_STAMP_RING_SIZE];
+	entry->time = time;
+	entry->stamp = stamp;
+	entry->clock = clock;
+	port->rx_stamps_count++;
+
+	spin_unlock_irqrestore(&port->rx_stamps_spinlock, stamps_flags);
+}
+
+/*
+	Returns 0 if no RFE interrupt is waiting for a frame. There can't be more
+	stamps than frames completed in the FIFO, any extra ones are left over
+	from frames that completed before their interrupt was handled.
+*/
+unsigned fscc_port_take_rx_stamp(struct fscc_port *port,
+								 struct fscc_rx_stamp *stamp,
+								 unsigned completed_frames)
+{
+	unsigned long stamps_flags = 0;
+	unsigned found = 0;
+
+	return_val_if_untrue(port, 0);
+
+	spin_lock_irqsave(&port->rx_stamps_spinlock, stamps_flags);
+
+	while (port->rx_stamps_count > completed_frames) {
+		port->rx_stamps_first = (port->rx_stamps_first + 1) % RX_STAMP_RING_SIZE;
+		port->rx_stamps_count--;
+	}
+
+	if (port->rx_stamps_count) {
+		*stamp = port->rx_stamps[port->rx_stamps_first];
+		port->rx_stamps_first = (port->rx_stamps_first + 1) % RX_STAMP_RING_SIZE;
+		port->rx_stamps_count--;
+		found = 1;
+	}
+
+	spin_unlock_irqrestore(&port->rx_stamps_spinlock, stamps_flags);
+
+	return found;
+}
+
+void fscc_port_clear_rx_stamps(struct fscc_port *port)
+{
+	unsigned long stamps_flags = 0;
+
+	return_if_untrue(port);
+
+	spin_lock_irqsave(&port->rx_stamps_spinlock, stamps_flags);
+	port->rx_stamps_count = 0;
+	spin_unlock_irqrestore(&port->rx_stamps_spinlock, stamps_flags);
+}
+
+/*
+	Records that a written frame left the card. Once the list is full the
+	oldest report is overwritten.
+*/
+void fscc_port_add_tx_report(struct fscc_port *port, __u64 cookie,
+							 __u64 timestamp, unsigned status)
+{
+	struct fscc_tx_reports *reports = 0;
+	struct fscc_tx_report *report = 0;
+	unsigned long reports_flags = 0;
+
+	return_if_untrue(port);
+
+	spin_lock_irqsave(&port->tx_reports_spinlock, reports_flags);
+
+	reports = &port->tx_report_list;
+
+	if (reports->count == FSCC_MAX_TX_REPORTS) {
+		memmove(&reports->reports[0], &reports->reports[1],
+				sizeof(reports->reports[0]) * (FSCC_MAX_TX_REPORTS - 1));
+		reports->count--;
+		reports->overwritten++;
+	}
+
+	report = &reports->reports[reports->count++];
+	report->cookie = cookie;
+	report->timestamp = timestamp;
+	report->status = status;
+	report->reserved = 0;
+
+	spin_unlock_irqrestore(&port->tx_reports_spinlock, reports_flags);
+}
+
+unsigned fscc_port_has_tx_reports(struct fscc_port *port)
+{
+	unsigned long reports_flags = 0;
+	unsigned count = 0;
+
+	return_val_if_untrue(port, 0);
+
+	spin_lock_irqsave(&port->tx_reports_spinlock, reports_flags);
+	count = port->tx_report_list.count;
+	spin_unlock_irqrestore(&port->tx_reports_spinlock, reports_flags);
+
+	return count > 0;
+}
+
+/* Copies out the transmit reports since the last call and forgets them. */
+void fscc_port_take_tx_reports(struct fscc_port *port,
+							   struct fscc_tx_reports *reports)
+{
+	unsigned long reports_flags = 0;
+
+	return_if_untrue(port);
+	return_if_untrue(reports);
+
+	spin_lock_irqsave(&port->tx_reports_spinlock, reports_flags);
+	memcpy(reports, &port->tx_report_list, sizeof(*reports));
+	memset(&port->tx_report_list, 0, sizeof(port->tx_report_list));
+	spin_unlock_irqrestore(&port->tx_reports_spinlock, reports_flags);
+}
+
+/* Copies out the losses reported since the last call and forgets them. */
+void fscc_port_take_rx_drops(struct fscc_port *port,
+							 struct fscc_rx_drops *drops)
+{
+	unsigned long drops_flags = 0;
+
+	return_if_untrue(port);
+	return_if_untrue(drops);
+
+	spin_lock_irqsave(&port->rx_drops_spinlock, drops_flags);
+	memcpy(drops, &port->rx_drops, sizeof(*drops));
+	memset(&port->rx_drops, 0, sizeof(port->rx_drops));
+	spin_unlock_irqrestore(&port->rx_drops_spinlock, drops_flags);
+}
+
+/* Reads data out of the FIFO without keeping it. */
+void fscc_port_discard_rx_data(struct fscc_port *port, unsigned length)
+{
+	unsigned i = 0;
+
+	return_if_untrue(port);
+
+	for (i = 0; i < (length + 3) / 4; i++)
+		fscc_port_get_register(port, 0, FIFO_OFFSET);
+}
+
+/* Restarts reception that was stopped by the block input cap policy. */
+void fscc_port_unblock_rx(struct fscc_port *port)
+{
+	return_if_untrue(port);
+
+	if (!port->rx_blocked)
+		return;
+
+	port->rx_blocked = 0;
+
+	if (fscc_port_is_streaming(port))
+		tasklet_schedule(&port->istream_tasklet);
+	else
+		tasklet_schedule(&port->iframe_tasklet);
+}
+
 #define STRB_BASE 0x00000008
 #define DTA_BASE 0x00000001
 #define CLK_BASE 0x00000002
@@ -1127,6 +2171,26 @@ int fscc_port_set_append_timestamp(struct fscc_port *port, unsigned value)
 	return 1;
 }
 
+int fscc_port_set_append_sequence(struct fscc_port *port, unsigned value)
+{
+	return_val_if_untrue(port, 0);
+
+	if (value && fscc_port_is_streaming(port))
+		return -EOPNOTSUPP;
+
+	if (port->append_sequence != value) {
+		dev_dbg(port->device, "append sequence %i => %i\n",
+				port->append_sequence, value);
+	}
+	else {
+		dev_dbg(port->device, "append sequence %i\n", value);
+	}
+
+	port->append_sequence = (value) ? 1 : 0;
+
+	return 1;
+}
+
 void fscc_port_set_ignore_timeout(struct fscc_port *port,
 								  unsigned value)
 {
@@ -1159,6 +2223,71 @@ void fscc_port_set_rx_multiple(struct fscc_port *port,
 	port->rx_multiple = (value) ? 1 : 0;
 }
 
+void fscc_port_set_tx_reports(struct fscc_port *port, unsigned value)
+{
+	return_if_untrue(port);
+
+	if (port->tx_reports != value) {
+		dev_dbg(port->device, "transmit reports %i => %i\n",
+				port->tx_reports, value);
+	}
+	else {
+		dev_dbg(port->device, "transmit reports %i\n", value);
+	}
+
+	port->tx_reports = (value) ? 1 : 0;
+}
+
+/* Sets the cookie given to the next frame written. */
+int fscc_port_set_tx_cookie(struct fscc_port *port, __u64 cookie)
+{
+	return_val_if_untrue(port, 0);
+
+	if (mutex_lock_interruptible(&port->write_mutex))
+		return -ERESTARTSYS;
+
+	dev_dbg(port->device, "transmit cookie %llu\n",
+			(unsigned long long)cookie);
+
+	port->tx_cookie = cookie;
+
+	mutex_unlock(&port->write_mutex);
+
+	return 1;
+}
+
+/*
+	Charges the change in the stream buffer's size to the budget. Called with
+	istream_spinlock held after anything that can resize the buffer.
+*/
+void fscc_port_charge_istream(struct fscc_port *port)
+{
+	unsigned usage = fscc_frame_get_memory_usage(port->istream);
+
+	fscc_budget_charge(port, (int)usage - (int)port->istream_usage);
+	port->istream_usage = usage;
+}
+
+void fscc_port_set_report_overflow(struct fscc_port *port,
+								   unsigned value)
+{
+	return_if_untrue(port);
+
+	if (port->report_overflow != value) {
+		dev_dbg(port->device, "report overflow %i => %i\n",
+				port->report_overflow, value);
+	}
+	else {
+		dev_dbg(port->device, "report overflow %i\n", value);
+	}
+
+	/* Don't report overflows that happened while reporting was off. */
+	if (value && !port->report_overflow)
+		atomic_set(&port->rx_overflow_reports, 0);
+
+	port->report_overflow = (value) ? 1 : 0;
+}
+
 unsigned fscc_port_get_append_status(struct fscc_port *port)
 {
 	return_val_if_untrue(port, 0);
@@ -1173,6 +2302,82 @@ unsigned fscc_port_get_append_timestamp(struct fscc_port *port)
 	return !fscc_port_is_streaming(port) && port->append_timestamp;
 }
 
+unsigned fscc_port_get_append_sequence(struct fscc_port *port)
+{
+	return_val_if_untrue(port, 0);
+
+	return !fscc_port_is_streaming(port) && port->append_sequence;
+}
+
+int fscc_port_set_timestamp_clock(struct fscc_port *port, unsigned value)
+{
+	return_val_if_untrue(port, 0);
+
+	switch (value) {
+	case FSCC_TIMESTAMP_LEGACY:
+	case FSCC_TIMESTAMP_REALTIME:
+	case FSCC_TIMESTAMP_MONOTONIC:
+		break;
+
+	case FSCC_TIMESTAMP_MONOTONIC_RAW:
+	case FSCC_TIMESTAMP_TAI:
+#if LINUX_VERSION_CODE < KERNEL_VERSION(3, 17, 0)
+		return -EOPNOTSUPP;
+#endif
+		break;
+
+	default:
+		dev_warn(port->device, "timestamp clock (invalid value %i)\n",
+				 value);
+
+		return -EINVAL;
+	}
+
+	if (port->timestamp_clock != value) {
+		dev_dbg(port->device, "timestamp clock %i => %i\n",
+				port->timestamp_clock, value);
+	}
+	else {
+		dev_dbg(port->device, "timestamp clock %i\n", value);
+	}
+
+	port->timestamp_clock = value;
+
+	return 1;
+}
+
+unsigned fscc_port_get_timestamp_clock(struct fscc_port *port)
+{
+	return_val_if_untrue(port, 0);
+
+	return port->timestamp_clock;
+}
+
+unsigned fscc_port_get_report_overflow(struct fscc_port *port)
+{
+	return_val_if_untrue(port, 0);
+
+	return port->report_overflow;
+}
+
+unsigned fscc_port_has_overflow_report(struct fscc_port *port)
+{
+	return_val_if_untrue(port, 0);
+
+	return port->report_overflow && atomic_read(&port->rx_overflow_reports);
+}
+
+/* Returns 1 (once) if there was a receive overflow since the last call. */
+unsigned fscc_port_take_overflow_report(struct fscc_port *port)
+{
+	return_val_if_untrue(port, 0);
+
+	if (!port->report_overflow)
+		return 0;
+
+	return atomic_xchg(&port->rx_overflow_reports, 0) ? 1 : 0;
+}
+
 unsigned fscc_port_get_ignore_timeout(struct fscc_port *port)
 {
 	return_val_if_untrue(port, 0);
@@ -1187,6 +2392,13 @@ unsigned fscc_port_get_rx_multiple(struct fscc_port *port)
 	return port->rx_multiple;
 }
 
+unsigned fscc_port_get_tx_reports(struct fscc_port *port)
+{
+	return_val_if_untrue(port, 0);
+
+	return port->tx_reports;
+}
+
 int fscc_port_execute_TRES(struct fscc_port *port)
 {
 	return_val_if_untrue(port, 0);
@@ -1288,6 +2500,14 @@ unsigned fscc_port_has_dma(struct fscc_port *port)
 	return port->card->dma;
 }
 
+void fscc_port_get_stats(struct fscc_port *port, struct fscc_stats *stats)
+{
+	return_if_untrue(port);
+	return_if_untrue(stats);
+
+	fscc_stats_get(port->stats, stats);
+}
+
 #ifdef DEBUG
 unsigned fscc_port_get_interrupt_count(struct fscc_port *port, __u32 isr_bit)
 {
@@ -1394,13 +2614,11 @@ int prepare_frame_for_dma(struct fscc_port *port, struct fscc_frame *frame,
 	struct fscc_frame *last_frame = 0;
 	unsigned long sent_flags = 0;
 
-	fscc_frame_setup_descriptors(frame);
-
 	spin_lock_irqsave(&port->sent_oframes_spinlock, sent_flags);
 
 	last_frame = fscc_flist_peek_back(&port->sent_oframes);
 
-	if (last_frame && last_frame->d1->control != 0x40000000) {
+	if (last_frame && !fscc_frame_is_sent(last_frame)) {
 		// Wait until last frame is finished
 		spin_unlock_irqrestore(&port->sent_oframes_spinlock, sent_flags);
 		//fscc_port_set_register(port, 2, DMA_TX_BASE_OFFSET, frame->d1_handle);
@@ -1471,6 +2689,18 @@ unsigned fscc_port_transmit_frame(struct fscc_port *port, struct fscc_frame *fra
 		transmit_dma = 1;
 	}
 
+	/* User pages can only be reached by the DMA engine. A frame queued before
+	   force_fifo was set is copied out of them instead, or still sent by DMA
+	   if there is no memory for that rather than being lost. */
+	if (fscc_frame_is_zero_copy(frame)) {
+		if (fscc_port_has_dma(port) || !fscc_frame_copy_user_pages(frame))
+			transmit_dma = 1;
+	}
+
+	/* Fall back to the FIFO if no descriptor could be set up. */
+	if (transmit_dma && !fscc_frame_setup_descriptors(frame))
+		transmit_dma = 0;
+
 	if (transmit_dma)
 		result = prepare_frame_for_dma(port, frame, &transmit_length);
 	else
@@ -1479,10 +2709,18 @@ unsigned fscc_port_transmit_frame(struct fscc_port *port, struct fscc_frame *fra
 	if (result)
 		fscc_port_execute_transmit(port, transmit_dma);
 
-	dev_dbg(port->device, "F#%i => %i byte%s%s\n",
-			frame->number, transmit_length,
-			(transmit_length == 1) ? "" : "s",
-			(result != 2) ? " (starting)" : "");
+	if (transmit_length)
+		fscc_stats_add(port, tx_bytes, transmit_length);
+
+	if (result == 2) {
+		fscc_stats_inc(port, tx_frames);
+
+		frame->handoff_time = fscc_latency_now();
+		fscc_latency_record(port->latency, FSCC_LATENCY_TX_WRITE_TO_HANDOFF,
+							frame->queued_time, frame->handoff_time);
+	}
+
+	trace_fscc_tx_start(port, frame, transmit_length, transmit_dma, result);
 
 	return result;
 }
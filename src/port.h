@@ -26,14 +26,21 @@
 #include <linux/interrupt.h> /* struct tasklet_struct */
 #include <linux/version.h> /* LINUX_VERSION_CODE, KERNEL_VERSION */
 
-#if LINUX_VERSION_CODE >= KERNEL_VERSION(2, 6, 26)
-#include <linux/semaphore.h> /* struct semaphore */
-#endif
+#include <linux/mutex.h> /* struct mutex */
+#include <linux/hrtimer.h> /* struct hrtimer */
+#include <linux/dmapool.h> /* struct dma_pool */
 
 #include "fscc.h" /* struct fscc_registers */
 #include "descriptor.h" /* struct fscc_descriptor */
 #include "debug.h" /* stuct debug_interrupt_tracker */
 #include "flist.h" /* struct fscc_registers */
+#include "stats.h" /* struct fscc_stats */
+#include "latency.h" /* struct fscc_latency */
+#include "budget.h" /* fscc_budget_* */
+#include "fifot.h" /* fscc_fifot_* */
+#include "netdev.h" /* fscc_netdev_* */
+#include "filter.h" /* struct fscc_filter */
+#include "address.h" /* struct fscc_address_set */
 
 #define FIFO_OFFSET 0x00
 #define BC_FIFO_L_OFFSET 0x04
@@ -89,8 +96,25 @@
 
 #define CE_BIT 0x00040000
 
+#define CCR0_ADM_MASK 0x01800000 /* Address mode */
+#define CCR0_ADM_8_BIT 0x00800000
+#define CCR0_ADM_16_BIT 0x01000000
+
+#define RX_STAMP_RING_SIZE 16
+
+/* Taken in the ISR for each RFE and handed to the next completed frame. */
+struct fscc_rx_stamp {
+	__u64 time; /* fscc_latency_now() (ns) */
+	__u64 stamp; /* On the timestamp clock (ns) */
+	unsigned clock;
+};
+
 struct fscc_port {
 	struct list_head list;
+	struct list_head budget_list;
+	atomic_t budget_usage; /* Memory held by the frame lists and stream */
+	unsigned long budget_waiting; /* Bit 0 set while held back by the budget */
+	unsigned istream_usage; /* Part of budget_usage that is the stream */
 	dev_t dev_t;
 	struct class *class;
 	struct cdev cdev;
@@ -99,13 +123,11 @@ struct fscc_port {
 	unsigned channel;
 	char *name;
 
+	struct dma_pool *descriptor_pool; /* Coherent, shared by every frame */
 	struct fscc_descriptor *null_descriptor;
 	dma_addr_t null_handle;
 
-	/* Prevents simultaneous read(), write() and poll() calls. */
-	struct semaphore read_semaphore;
-	struct semaphore write_semaphore;
-	struct semaphore poll_semaphore;
+	struct mutex write_mutex; /* Serializes write() cap checks */
 
 	wait_queue_head_t input_queue;
 	wait_queue_head_t output_queue;
@@ -130,6 +152,28 @@ struct fscc_port {
 
 	unsigned append_status;
 	unsigned append_timestamp;
+	unsigned append_sequence;
+	unsigned timestamp_clock;
+	unsigned report_overflow;
+	struct fscc_filter *rx_filter; /* Protected by pending_iframe_spinlock */
+	struct fscc_address_set *address_set; /* Protected by pending_iframe_spinlock */
+	__u32 address_rar; /* RAR and RAMR from before the address filter */
+	__u32 address_ramr;
+	__u32 address_ccr0; /* Only the address mode bits are restored */
+
+	/* Receive overflow recovery, protected by pending_iframe_spinlock */
+	unsigned rx_overflow; /* RDO/RFO bits not yet handled */
+	unsigned rx_overflow_frames; /* Good frames in the FIFO at RDO time */
+	unsigned rx_discard; /* Drop the next frame after rx_discard_skip */
+	unsigned rx_discard_skip;
+	unsigned rx_discard_reason;
+
+	atomic_t rx_overflow_reports; /* Overflows not yet reported to a reader */
+
+	/* Receive sequence numbers, protected by pending_iframe_spinlock */
+	__u32 rx_sequence; /* Given to the next frame that completes */
+	__u32 tx_sequence; /* Protected by queued_oframes_spinlock */
+	struct fscc_rx_drops rx_drops; /* Protected by rx_drops_spinlock */
 
 	spinlock_t board_settings_spinlock; /* Anything that will alter the settings at a board level */
 	spinlock_t board_rx_spinlock; /* Anything that will alter the state of rx at a board level */
@@ -141,13 +185,64 @@ struct fscc_port {
 	spinlock_t sent_oframes_spinlock;
 	spinlock_t queued_oframes_spinlock;
 	spinlock_t queued_iframes_spinlock;
+	spinlock_t rx_drops_spinlock;
+	spinlock_t rx_stamps_spinlock;
+	spinlock_t tx_reports_spinlock;
 
 	struct fscc_memory_cap memory_cap;
+	unsigned input_cap_policy;
+	unsigned rx_blocked; /* Data left in the FIFO because of the memory cap */
+	unsigned rejected_last_frame;
+	unsigned rejected_last_stream;
 	unsigned ignore_timeout;
 	unsigned rx_multiple;
 	int tx_modifiers;
 
-	struct timer_list timer;
+	struct hrtimer flush_timer;
+	unsigned long flush_armed;
+	unsigned flush_timeout; /* Microseconds */
+	__u64 last_activity; /* Last interrupt (ns) */
+
+	struct fscc_fifot_adapt fifot_adapt;
+	struct timer_list fifot_timer;
+	struct fscc_stats fifot_last; /* Counters at the last adjustment */
+	unsigned fifot_rx_ceiling; /* Receive trigger level that overflowed */
+	unsigned fifot_pinned; /* User wrote FIFOT, adaptation leaves it alone */
+
+	unsigned tx_zero_copy; /* Smallest frame sent from user pages, 0 is off */
+	unsigned tx_zero_copy_queued; /* Sequence of the last zero copy frame */
+	atomic_t tx_zero_copy_done; /* Sequence of the last one released */
+
+	unsigned tx_reports; /* Report when written frames leave the card */
+	__u64 tx_cookie; /* Given to the next write, protected by write_mutex */
+	atomic_t tx_underrun; /* TDU seen since frames were last cleared */
+	struct fscc_tx_reports tx_report_list; /* Protected by tx_reports_spinlock */
+
+	struct fscc_wakeup wakeup;
+	struct timer_list rx_wake_timer;
+	unsigned rx_wake_expired; /* Queued data waited longer than rx_timeout */
+
+	struct fscc_stats __percpu *stats;
+	struct fscc_latency __percpu *latency;
+	struct dentry *debugfs_dir;
+
+#ifdef FSCC_HDLC
+	struct net_device *netdev; /* Generic HDLC interface, if registered */
+	struct napi_struct napi;
+	unsigned netdev_up; /* Received frames go to the network stack */
+#ifdef FSCC_XDP
+	struct bpf_prog __rcu *xdp_prog;
+	struct xdp_rxq_info xdp_rxq;
+#endif
+#endif
+
+	/* RFE interrupts not yet matched to a completed frame, protected by
+	   rx_stamps_spinlock. */
+	struct fscc_rx_stamp rx_stamps[RX_STAMP_RING_SIZE];
+	unsigned rx_stamps_first;
+	unsigned rx_stamps_count;
+	__u64 tx_isr_time; /* Last ALLS or DT_FE interrupt (ns) */
+	__u64 tx_isr_stamp; /* ... on the timestamp clock (ns) */
 
 #ifdef DEBUG
 	struct debug_interrupt_tracker *interrupt_tracker;
@@ -162,7 +257,9 @@ struct fscc_port *fscc_port_new(struct fscc_card *card, unsigned channel,
 
 void fscc_port_delete(struct fscc_port *port);
 
-int fscc_port_write(struct fscc_port *port, const char *data, unsigned length);
+int fscc_port_write(struct fscc_port *port, const char *data, unsigned length,
+					unsigned zero_copy);
+void fscc_port_queue_frame(struct fscc_port *port, struct fscc_frame *frame);
 ssize_t fscc_port_read(struct fscc_port *port, char *buf, size_t count);
 
 unsigned fscc_port_has_iframes(struct fscc_port *port, unsigned lock);
@@ -205,10 +302,19 @@ unsigned fscc_port_get_input_number_frames(struct fscc_port *port);
 
 unsigned fscc_port_get_input_memory_cap(struct fscc_port *port);
 unsigned fscc_port_get_output_memory_cap(struct fscc_port *port);
+unsigned fscc_port_get_input_memory_limit(struct fscc_port *port);
+unsigned fscc_port_get_output_memory_limit(struct fscc_port *port);
 
 void fscc_port_set_memory_cap(struct fscc_port *port,
 							  struct fscc_memory_cap *memory_cap);
 
+int fscc_port_set_input_cap_policy(struct fscc_port *port, unsigned value);
+unsigned fscc_port_get_input_cap_policy(struct fscc_port *port);
+unsigned fscc_port_evict_iframes(struct fscc_port *port, unsigned length,
+								 unsigned reason);
+void fscc_port_discard_rx_data(struct fscc_port *port, unsigned length);
+void fscc_port_unblock_rx(struct fscc_port *port);
+
 void fscc_port_set_ignore_timeout(struct fscc_port *port,
 								  unsigned ignore_timeout);
 unsigned fscc_port_get_ignore_timeout(struct fscc_port *port);
@@ -217,6 +323,15 @@ void fscc_port_set_rx_multiple(struct fscc_port *port,
 								  unsigned rx_multiple);
 unsigned fscc_port_get_rx_multiple(struct fscc_port *port);
 
+void fscc_port_set_tx_reports(struct fscc_port *port, unsigned value);
+unsigned fscc_port_get_tx_reports(struct fscc_port *port);
+int fscc_port_set_tx_cookie(struct fscc_port *port, __u64 cookie);
+void fscc_port_add_tx_report(struct fscc_port *port, __u64 cookie,
+							 __u64 timestamp, unsigned status);
+unsigned fscc_port_has_tx_reports(struct fscc_port *port);
+void fscc_port_take_tx_reports(struct fscc_port *port,
+							   struct fscc_tx_reports *reports);
+
 void fscc_port_set_clock_bits(struct fscc_port *port,
 							  unsigned char *clock_data);
 
@@ -226,6 +341,31 @@ unsigned fscc_port_get_append_status(struct fscc_port *port);
 int fscc_port_set_append_timestamp(struct fscc_port *port, unsigned value);
 unsigned fscc_port_get_append_timestamp(struct fscc_port *port);
 
+int fscc_port_set_timestamp_clock(struct fscc_port *port, unsigned value);
+unsigned fscc_port_get_timestamp_clock(struct fscc_port *port);
+
+int fscc_port_set_append_sequence(struct fscc_port *port, unsigned value);
+unsigned fscc_port_get_append_sequence(struct fscc_port *port);
+
+void fscc_port_add_rx_drop(struct fscc_port *port, __u32 sequence,
+						   unsigned reason);
+void fscc_port_take_rx_drops(struct fscc_port *port,
+							 struct fscc_rx_drops *drops);
+
+void fscc_port_add_rx_stamp(struct fscc_port *port, __u64 time, __u64 stamp,
+							unsigned clock);
+unsigned fscc_port_take_rx_stamp(struct fscc_port *port,
+								 struct fscc_rx_stamp *stamp,
+								 unsigned completed_frames);
+void fscc_port_clear_rx_stamps(struct fscc_port *port);
+
+void fscc_port_charge_istream(struct fscc_port *port);
+
+void fscc_port_set_report_overflow(struct fscc_port *port, unsigned value);
+unsigned fscc_port_get_report_overflow(struct fscc_port *port);
+unsigned fscc_port_has_overflow_report(struct fscc_port *port);
+unsigned fscc_port_take_overflow_report(struct fscc_port *port);
+
 int fscc_port_set_registers(struct fscc_port *port,
 							 const struct fscc_registers *regs);
 
@@ -252,11 +392,34 @@ void fscc_port_increment_interrupt_counts(struct fscc_port *port,
 										  __u32 isr_value);
 #endif /* DEBUG */
 
+void fscc_port_get_stats(struct fscc_port *port, struct fscc_stats *stats);
+
 int fscc_port_set_tx_modifiers(struct fscc_port *port, int tx_modifiers);
 unsigned fscc_port_get_tx_modifiers(struct fscc_port *port);
 void fscc_port_execute_transmit(struct fscc_port *port, unsigned dma);
 
-void fscc_port_reset_timer(struct fscc_port *port);
+void fscc_port_kick_flush_timer(struct fscc_port *port);
+int fscc_port_set_flush_timeout(struct fscc_port *port, unsigned value);
+unsigned fscc_port_get_flush_timeout(struct fscc_port *port);
+
+void fscc_port_set_wakeup(struct fscc_port *port, struct fscc_wakeup *value);
+void fscc_port_get_wakeup(struct fscc_port *port, struct fscc_wakeup *value);
+unsigned fscc_port_rx_wake_ready(struct fscc_port *port);
+unsigned fscc_port_tx_wake_ready(struct fscc_port *port);
+void fscc_port_wake_readers(struct fscc_port *port);
+void fscc_port_wake_writers(struct fscc_port *port);
+int fscc_port_set_tx_zero_copy(struct fscc_port *port, unsigned value);
+int fscc_port_set_rx_filter(struct fscc_port *port,
+							const struct sock_fprog *fprog);
+int fscc_port_set_address_filter(struct fscc_port *port,
+								 const struct fscc_address_filter *filter);
+void fscc_port_get_address_filter(struct fscc_port *port,
+								  struct fscc_address_filter *filter);
+unsigned fscc_port_get_tx_zero_copy(struct fscc_port *port);
+unsigned fscc_port_uses_zero_copy(struct fscc_port *port, unsigned length);
+void fscc_port_wait_zero_copy(struct fscc_port *port, unsigned sequence);
+unsigned fscc_port_get_zero_copy_in_flight(struct fscc_port *port);
+
 unsigned fscc_port_transmit_frame(struct fscc_port *port, struct fscc_frame *frame);
 
 #endif
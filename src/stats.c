@@ -0,0 +1,141 @@
+/*
+	Copyright (C) 2014 Commtech, Inc.
+
+	This file is part of fscc-linux.
+
+	fscc-linux is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	fscc-linux is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with fscc-linux.	If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include <linux/kernel.h> /* scnprintf */
+
+#include "stats.h"
+#include "port.h" /* RFE, RFT, ... */
+#include "utils.h" /* return_{val_}if_untrue */
+
+struct fscc_stats __percpu *fscc_stats_new(void)
+{
+	return alloc_percpu(struct fscc_stats);
+}
+
+void fscc_stats_delete(struct fscc_stats __percpu *stats)
+{
+	return_if_untrue(stats);
+
+	free_percpu(stats);
+}
+
+void fscc_stats_increment_interrupts(struct fscc_stats __percpu *stats,
+									 __u32 isr_value)
+{
+	this_cpu_inc(stats->interrupts);
+
+	if (isr_value & RFS)
+		this_cpu_inc(stats->rfs);
+
+	if (isr_value & RFT)
+		this_cpu_inc(stats->rft);
+
+	if (isr_value & RFE)
+		this_cpu_inc(stats->rfe);
+
+	if (isr_value & RFO)
+		this_cpu_inc(stats->rfo);
+
+	if (isr_value & RDO)
+		this_cpu_inc(stats->rdo);
+
+	if (isr_value & RFL)
+		this_cpu_inc(stats->rfl);
+
+	if (isr_value & TFT)
+		this_cpu_inc(stats->tft);
+
+	if (isr_value & ALLS)
+		this_cpu_inc(stats->alls);
+
+	if (isr_value & TDU)
+		this_cpu_inc(stats->tdu);
+}
+
+/* Every counter is a __u64 so the per CPU copies can be summed as arrays. */
+void fscc_stats_get(struct fscc_stats __percpu *stats,
+					struct fscc_stats *snapshot)
+{
+	unsigned cpu = 0;
+	unsigned i = 0;
+
+	return_if_untrue(stats);
+	return_if_untrue(snapshot);
+
+	memset(snapshot, 0, sizeof(*snapshot));
+
+	for_each_possible_cpu(cpu) {
+		__u64 *counters = (__u64 *)per_cpu_ptr(stats, cpu);
+
+		for (i = 0; i < sizeof(*snapshot) / sizeof(__u64); i++)
+			((__u64 *)snapshot)[i] += counters[i];
+	}
+}
+
+ssize_t fscc_stats_print(struct fscc_stats *snapshot, char *buf, size_t size)
+{
+	return scnprintf(buf, size,
+					 "interrupts %llu\n"
+					 "rfs %llu\n"
+					 "rft %llu\n"
+					 "rfe %llu\n"
+					 "rfo %llu\n"
+					 "rdo %llu\n"
+					 "rfl %llu\n"
+					 "tft %llu\n"
+					 "alls %llu\n"
+					 "tdu %llu\n"
+					 "rx_frames %llu\n"
+					 "rx_bytes %llu\n"
+					 "rx_dropped %llu\n"
+					 "rx_memory_cap_rejects %llu\n"
+					 "rx_cap_dropped_newest %llu\n"
+					 "rx_cap_dropped_oldest %llu\n"
+					 "rx_cap_blocked %llu\n"
+					 "rx_reclaimed %llu\n"
+					 "rx_filtered %llu\n"
+					 "rx_address_rejects %llu\n"
+					 "tx_frames %llu\n"
+					 "tx_bytes %llu\n"
+					 "tx_memory_cap_rejects %llu\n",
+					 snapshot->interrupts,
+					 snapshot->rfs,
+					 snapshot->rft,
+					 snapshot->rfe,
+					 snapshot->rfo,
+					 snapshot->rdo,
+					 snapshot->rfl,
+					 snapshot->tft,
+					 snapshot->alls,
+					 snapshot->tdu,
+					 snapshot->rx_frames,
+					 snapshot->rx_bytes,
+					 snapshot->rx_dropped,
+					 snapshot->rx_memory_cap_rejects,
+					 snapshot->rx_cap_dropped_newest,
+					 snapshot->rx_cap_dropped_oldest,
+					 snapshot->rx_cap_blocked,
+					 snapshot->rx_reclaimed,
+					 snapshot->rx_filtered,
+					 snapshot->rx_address_rejects,
+					 snapshot->tx_frames,
+					 snapshot->tx_bytes,
+					 snapshot->tx_memory_cap_rejects);
+}
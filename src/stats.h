@@ -0,0 +1,45 @@
+/*
+	Copyright (C) 2014 Commtech, Inc.
+
+	This file is part of fscc-linux.
+
+	fscc-linux is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	fscc-linux is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with fscc-linux.	If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef FSCC_STATS_H
+#define FSCC_STATS_H
+
+#include <linux/percpu.h> /* alloc_percpu, this_cpu_* */
+
+#include "fscc.h" /* struct fscc_stats */
+
+/*
+	Each CPU gets its own copy of the counters so the interrupt handler and
+	tasklets can update them without taking a lock. Readers sum all of the
+	copies into a single snapshot.
+*/
+#define fscc_stats_inc(port, field) this_cpu_inc((port)->stats->field)
+#define fscc_stats_add(port, field, value) \
+	this_cpu_add((port)->stats->field, (value))
+
+struct fscc_stats __percpu *fscc_stats_new(void);
+void fscc_stats_delete(struct fscc_stats __percpu *stats);
+void fscc_stats_increment_interrupts(struct fscc_stats __percpu *stats,
+									 __u32 isr_value);
+void fscc_stats_get(struct fscc_stats __percpu *stats,
+					struct fscc_stats *snapshot);
+ssize_t fscc_stats_print(struct fscc_stats *snapshot, char *buf, size_t size);
+
+#endif
@@ -33,6 +33,7 @@ static ssize_t register_store(struct kobject *kobj,
 	int register_offset = 0;
 	unsigned value = 0;
 	char *end = 0;
+	unsigned long flags;
 
 	port = (struct fscc_port *)dev_get_drvdata((struct device *)kobj);
 
@@ -40,7 +41,13 @@ static ssize_t register_store(struct kobject *kobj,
 	value = (unsigned)simple_strtoul(buf, &end, 16);
 
 	if (register_offset >= 0) {
+		spin_lock_irqsave(&port->board_settings_spinlock, flags);
 		fscc_port_set_register(port, bar_number, register_offset, value);
+
+		if (bar_number == 0 && register_offset == FIFOT_OFFSET)
+			fscc_fifot_pin(port);
+
+		spin_unlock_irqrestore(&port->board_settings_spinlock, flags);
 		return count;
 	}
 
@@ -297,6 +304,39 @@ static ssize_t input_frames(struct kobject *kobj, struct kobj_attribute *attr,
 	return sprintf(buf, "%i\n", fscc_port_get_input_number_frames(port));
 }
 
+static ssize_t stats(struct kobject *kobj, struct kobj_attribute *attr,
+					 char *buf)
+{
+	struct fscc_port *port = 0;
+	struct fscc_stats snapshot;
+
+	port = (struct fscc_port *)dev_get_drvdata((struct device *)kobj);
+
+	fscc_port_get_stats(port, &snapshot);
+
+	return fscc_stats_print(&snapshot, buf, PAGE_SIZE);
+}
+
+static ssize_t fifot_rx(struct kobject *kobj, struct kobj_attribute *attr,
+						char *buf)
+{
+	struct fscc_port *port = 0;
+
+	port = (struct fscc_port *)dev_get_drvdata((struct device *)kobj);
+
+	return sprintf(buf, "%u\n", fscc_fifot_get_rx(port));
+}
+
+static ssize_t fifot_tx(struct kobject *kobj, struct kobj_attribute *attr,
+						char *buf)
+{
+	struct fscc_port *port = 0;
+
+	port = (struct fscc_port *)dev_get_drvdata((struct device *)kobj);
+
+	return sprintf(buf, "%u\n", fscc_fifot_get_tx(port));
+}
+
 static struct kobj_attribute output_memory_attribute =
 	__ATTR(output_memory, SYSFS_READ_ONLY_MODE, output_memory, 0);
 
@@ -309,11 +349,23 @@ static struct kobj_attribute output_frames_attribute =
 static struct kobj_attribute input_frames_attribute =
 	__ATTR(input_frames, SYSFS_READ_ONLY_MODE, input_frames, 0);
 
+static struct kobj_attribute stats_attribute =
+	__ATTR(stats, SYSFS_READ_ONLY_MODE, stats, 0);
+
+static struct kobj_attribute fifot_rx_attribute =
+	__ATTR(fifot_rx, SYSFS_READ_ONLY_MODE, fifot_rx, 0);
+
+static struct kobj_attribute fifot_tx_attribute =
+	__ATTR(fifot_tx, SYSFS_READ_ONLY_MODE, fifot_tx, 0);
+
 static struct attribute *info_attrs[] = {
 	&output_memory_attribute.attr,
 	&input_memory_attribute.attr,
 	&output_frames_attribute.attr,
 	&input_frames_attribute.attr,
+	&stats_attribute.attr,
+	&fifot_rx_attribute.attr,
+	&fifot_tx_attribute.attr,
 	NULL,
 };
 
@@ -408,6 +460,33 @@ static ssize_t rx_multiple_show(struct kobject *kobj,
 	return sprintf(buf, "%i\n", fscc_port_get_rx_multiple(port));
 }
 
+static ssize_t tx_reports_store(struct kobject *kobj,
+								struct kobj_attribute *attr, const char *buf,
+								size_t count)
+{
+	struct fscc_port *port = 0;
+	unsigned value = 0;
+	char *end = 0;
+
+	port = (struct fscc_port *)dev_get_drvdata((struct device *)kobj);
+
+	value = (unsigned)simple_strtoul(buf, &end, 16);
+
+	fscc_port_set_tx_reports(port, value);
+
+	return count;
+}
+
+static ssize_t tx_reports_show(struct kobject *kobj,
+							   struct kobj_attribute *attr, char *buf)
+{
+	struct fscc_port *port = 0;
+
+	port = (struct fscc_port *)dev_get_drvdata((struct device *)kobj);
+
+	return sprintf(buf, "%i\n", fscc_port_get_tx_reports(port));
+}
+
 static ssize_t append_status_store(struct kobject *kobj,
 								   struct kobj_attribute *attr, const char *buf,
 								   size_t count)
@@ -462,6 +541,466 @@ static ssize_t append_timestamp_show(struct kobject *kobj,
 	return sprintf(buf, "%i\n", fscc_port_get_append_timestamp(port));
 }
 
+static ssize_t append_sequence_store(struct kobject *kobj,
+								   struct kobj_attribute *attr, const char *buf,
+								   size_t count)
+{
+	struct fscc_port *port = 0;
+	unsigned value = 0;
+	char *end = 0;
+
+	port = (struct fscc_port *)dev_get_drvdata((struct device *)kobj);
+
+	value = (unsigned)simple_strtoul(buf, &end, 16);
+
+	fscc_port_set_append_sequence(port, value);
+
+	return count;
+}
+
+static ssize_t append_sequence_show(struct kobject *kobj,
+								  struct kobj_attribute *attr, char *buf)
+{
+	struct fscc_port *port = 0;
+
+	port = (struct fscc_port *)dev_get_drvdata((struct device *)kobj);
+
+	return sprintf(buf, "%i\n", fscc_port_get_append_sequence(port));
+}
+
+static ssize_t report_overflow_store(struct kobject *kobj,
+									 struct kobj_attribute *attr, const char *buf,
+									 size_t count)
+{
+	struct fscc_port *port = 0;
+	unsigned value = 0;
+	char *end = 0;
+
+	port = (struct fscc_port *)dev_get_drvdata((struct device *)kobj);
+
+	value = (unsigned)simple_strtoul(buf, &end, 16);
+
+	fscc_port_set_report_overflow(port, value);
+
+	return count;
+}
+
+static ssize_t report_overflow_show(struct kobject *kobj,
+									struct kobj_attribute *attr, char *buf)
+{
+	struct fscc_port *port = 0;
+
+	port = (struct fscc_port *)dev_get_drvdata((struct device *)kobj);
+
+	return sprintf(buf, "%i\n", fscc_port_get_report_overflow(port));
+}
+
+static ssize_t flush_timeout_store(struct kobject *kobj,
+								   struct kobj_attribute *attr, const char *buf,
+								   size_t count)
+{
+	struct fscc_port *port = 0;
+	unsigned value = 0;
+	char *end = 0;
+
+	port = (struct fscc_port *)dev_get_drvdata((struct device *)kobj);
+
+	value = (unsigned)simple_strtoul(buf, &end, 10);
+
+	if (fscc_port_set_flush_timeout(port, value) < 0)
+		return -EINVAL;
+
+	return count;
+}
+
+static ssize_t flush_timeout_show(struct kobject *kobj,
+								  struct kobj_attribute *attr, char *buf)
+{
+	struct fscc_port *port = 0;
+
+	port = (struct fscc_port *)dev_get_drvdata((struct device *)kobj);
+
+	return sprintf(buf, "%u\n", fscc_port_get_flush_timeout(port));
+}
+
+static ssize_t tx_zero_copy_store(struct kobject *kobj,
+								  struct kobj_attribute *attr, const char *buf,
+								  size_t count)
+{
+	struct fscc_port *port = 0;
+	unsigned value = 0;
+	char *end = 0;
+
+	port = (struct fscc_port *)dev_get_drvdata((struct device *)kobj);
+
+	value = (unsigned)simple_strtoul(buf, &end, 10);
+
+	if (fscc_port_set_tx_zero_copy(port, value) < 0)
+		return -EINVAL;
+
+	return count;
+}
+
+static ssize_t tx_zero_copy_show(struct kobject *kobj,
+								 struct kobj_attribute *attr, char *buf)
+{
+	struct fscc_port *port = 0;
+
+	port = (struct fscc_port *)dev_get_drvdata((struct device *)kobj);
+
+	return sprintf(buf, "%u\n", fscc_port_get_tx_zero_copy(port));
+}
+
+static ssize_t timestamp_clock_store(struct kobject *kobj,
+									 struct kobj_attribute *attr, const char *buf,
+									 size_t count)
+{
+	struct fscc_port *port = 0;
+	unsigned value = 0;
+	char *end = 0;
+	int error_code = 0;
+
+	port = (struct fscc_port *)dev_get_drvdata((struct device *)kobj);
+
+	value = (unsigned)simple_strtoul(buf, &end, 10);
+
+	if ((error_code = fscc_port_set_timestamp_clock(port, value)) < 0)
+		return error_code;
+
+	return count;
+}
+
+static ssize_t timestamp_clock_show(struct kobject *kobj,
+									struct kobj_attribute *attr, char *buf)
+{
+	struct fscc_port *port = 0;
+
+	port = (struct fscc_port *)dev_get_drvdata((struct device *)kobj);
+
+	return sprintf(buf, "%i\n", fscc_port_get_timestamp_clock(port));
+}
+
+static ssize_t input_cap_policy_store(struct kobject *kobj,
+									  struct kobj_attribute *attr, const char *buf,
+									  size_t count)
+{
+	struct fscc_port *port = 0;
+	unsigned value = 0;
+	char *end = 0;
+
+	port = (struct fscc_port *)dev_get_drvdata((struct device *)kobj);
+
+	value = (unsigned)simple_strtoul(buf, &end, 10);
+
+	if (fscc_port_set_input_cap_policy(port, value) < 0)
+		return -EINVAL;
+
+	return count;
+}
+
+static ssize_t input_cap_policy_show(struct kobject *kobj,
+									 struct kobj_attribute *attr, char *buf)
+{
+	struct fscc_port *port = 0;
+
+	port = (struct fscc_port *)dev_get_drvdata((struct device *)kobj);
+
+	return sprintf(buf, "%i\n", fscc_port_get_input_cap_policy(port));
+}
+
+static ssize_t rx_wake_frames_store(struct kobject *kobj,
+									struct kobj_attribute *attr, const char *buf,
+									size_t count)
+{
+	struct fscc_port *port = 0;
+	struct fscc_wakeup wakeup;
+	char *end = 0;
+
+	port = (struct fscc_port *)dev_get_drvdata((struct device *)kobj);
+
+	FSCC_WAKEUP_INIT(wakeup);
+
+	wakeup.rx_frames = (int)simple_strtoul(buf, &end, 10);
+
+	fscc_port_set_wakeup(port, &wakeup);
+
+	return count;
+}
+
+static ssize_t rx_wake_frames_show(struct kobject *kobj,
+								   struct kobj_attribute *attr, char *buf)
+{
+	struct fscc_port *port = 0;
+	struct fscc_wakeup wakeup;
+
+	port = (struct fscc_port *)dev_get_drvdata((struct device *)kobj);
+
+	fscc_port_get_wakeup(port, &wakeup);
+
+	return sprintf(buf, "%i\n", wakeup.rx_frames);
+}
+
+static ssize_t rx_wake_bytes_store(struct kobject *kobj,
+									struct kobj_attribute *attr, const char *buf,
+									size_t count)
+{
+	struct fscc_port *port = 0;
+	struct fscc_wakeup wakeup;
+	char *end = 0;
+
+	port = (struct fscc_port *)dev_get_drvdata((struct device *)kobj);
+
+	FSCC_WAKEUP_INIT(wakeup);
+
+	wakeup.rx_bytes = (int)simple_strtoul(buf, &end, 10);
+
+	fscc_port_set_wakeup(port, &wakeup);
+
+	return count;
+}
+
+static ssize_t rx_wake_bytes_show(struct kobject *kobj,
+								   struct kobj_attribute *attr, char *buf)
+{
+	struct fscc_port *port = 0;
+	struct fscc_wakeup wakeup;
+
+	port = (struct fscc_port *)dev_get_drvdata((struct device *)kobj);
+
+	fscc_port_get_wakeup(port, &wakeup);
+
+	return sprintf(buf, "%i\n", wakeup.rx_bytes);
+}
+
+static ssize_t rx_wake_timeout_store(struct kobject *kobj,
+									struct kobj_attribute *attr, const char *buf,
+									size_t count)
+{
+	struct fscc_port *port = 0;
+	struct fscc_wakeup wakeup;
+	char *end = 0;
+
+	port = (struct fscc_port *)dev_get_drvdata((struct device *)kobj);
+
+	FSCC_WAKEUP_INIT(wakeup);
+
+	wakeup.rx_timeout = (int)simple_strtoul(buf, &end, 10);
+
+	fscc_port_set_wakeup(port, &wakeup);
+
+	return count;
+}
+
+static ssize_t rx_wake_timeout_show(struct kobject *kobj,
+								   struct kobj_attribute *attr, char *buf)
+{
+	struct fscc_port *port = 0;
+	struct fscc_wakeup wakeup;
+
+	port = (struct fscc_port *)dev_get_drvdata((struct device *)kobj);
+
+	fscc_port_get_wakeup(port, &wakeup);
+
+	return sprintf(buf, "%i\n", wakeup.rx_timeout);
+}
+
+static ssize_t tx_wake_bytes_store(struct kobject *kobj,
+									struct kobj_attribute *attr, const char *buf,
+									size_t count)
+{
+	struct fscc_port *port = 0;
+	struct fscc_wakeup wakeup;
+	char *end = 0;
+
+	port = (struct fscc_port *)dev_get_drvdata((struct device *)kobj);
+
+	FSCC_WAKEUP_INIT(wakeup);
+
+	wakeup.tx_bytes = (int)simple_strtoul(buf, &end, 10);
+
+	fscc_port_set_wakeup(port, &wakeup);
+
+	return count;
+}
+
+static ssize_t tx_wake_bytes_show(struct kobject *kobj,
+								   struct kobj_attribute *attr, char *buf)
+{
+	struct fscc_port *port = 0;
+	struct fscc_wakeup wakeup;
+
+	port = (struct fscc_port *)dev_get_drvdata((struct device *)kobj);
+
+	fscc_port_get_wakeup(port, &wakeup);
+
+	return sprintf(buf, "%i\n", wakeup.tx_bytes);
+}
+
+static ssize_t fifot_adapt_store(struct kobject *kobj,
+								 struct kobj_attribute *attr, const char *buf,
+								 size_t count)
+{
+	struct fscc_port *port = 0;
+	struct fscc_fifot_adapt adapt;
+	char *end = 0;
+
+	port = (struct fscc_port *)dev_get_drvdata((struct device *)kobj);
+
+	FSCC_FIFOT_ADAPT_INIT(adapt);
+
+	adapt.enabled = (int)simple_strtoul(buf, &end, 10);
+
+	if (fscc_fifot_set_adapt(port, &adapt) < 0)
+		return -EINVAL;
+
+	return count;
+}
+
+static ssize_t fifot_adapt_show(struct kobject *kobj,
+								struct kobj_attribute *attr, char *buf)
+{
+	struct fscc_port *port = 0;
+	struct fscc_fifot_adapt adapt;
+
+	port = (struct fscc_port *)dev_get_drvdata((struct device *)kobj);
+
+	fscc_fifot_get_adapt(port, &adapt);
+
+	return sprintf(buf, "%i\n", adapt.enabled);
+}
+
+static ssize_t fifot_rx_min_store(struct kobject *kobj,
+								 struct kobj_attribute *attr, const char *buf,
+								 size_t count)
+{
+	struct fscc_port *port = 0;
+	struct fscc_fifot_adapt adapt;
+	char *end = 0;
+
+	port = (struct fscc_port *)dev_get_drvdata((struct device *)kobj);
+
+	FSCC_FIFOT_ADAPT_INIT(adapt);
+
+	adapt.rx_min = (int)simple_strtoul(buf, &end, 10);
+
+	if (fscc_fifot_set_adapt(port, &adapt) < 0)
+		return -EINVAL;
+
+	return count;
+}
+
+static ssize_t fifot_rx_min_show(struct kobject *kobj,
+								struct kobj_attribute *attr, char *buf)
+{
+	struct fscc_port *port = 0;
+	struct fscc_fifot_adapt adapt;
+
+	port = (struct fscc_port *)dev_get_drvdata((struct device *)kobj);
+
+	fscc_fifot_get_adapt(port, &adapt);
+
+	return sprintf(buf, "%i\n", adapt.rx_min);
+}
+
+static ssize_t fifot_rx_max_store(struct kobject *kobj,
+								 struct kobj_attribute *attr, const char *buf,
+								 size_t count)
+{
+	struct fscc_port *port = 0;
+	struct fscc_fifot_adapt adapt;
+	char *end = 0;
+
+	port = (struct fscc_port *)dev_get_drvdata((struct device *)kobj);
+
+	FSCC_FIFOT_ADAPT_INIT(adapt);
+
+	adapt.rx_max = (int)simple_strtoul(buf, &end, 10);
+
+	if (fscc_fifot_set_adapt(port, &adapt) < 0)
+		return -EINVAL;
+
+	return count;
+}
+
+static ssize_t fifot_rx_max_show(struct kobject *kobj,
+								struct kobj_attribute *attr, char *buf)
+{
+	struct fscc_port *port = 0;
+	struct fscc_fifot_adapt adapt;
+
+	port = (struct fscc_port *)dev_get_drvdata((struct device *)kobj);
+
+	fscc_fifot_get_adapt(port, &adapt);
+
+	return sprintf(buf, "%i\n", adapt.rx_max);
+}
+
+static ssize_t fifot_tx_min_store(struct kobject *kobj,
+								 struct kobj_attribute *attr, const char *buf,
+								 size_t count)
+{
+	struct fscc_port *port = 0;
+	struct fscc_fifot_adapt adapt;
+	char *end = 0;
+
+	port = (struct fscc_port *)dev_get_drvdata((struct device *)kobj);
+
+	FSCC_FIFOT_ADAPT_INIT(adapt);
+
+	adapt.tx_min = (int)simple_strtoul(buf, &end, 10);
+
+	if (fscc_fifot_set_adapt(port, &adapt) < 0)
+		return -EINVAL;
+
+	return count;
+}
+
+static ssize_t fifot_tx_min_show(struct kobject *kobj,
+								struct kobj_attribute *attr, char *buf)
+{
+	struct fscc_port *port = 0;
+	struct fscc_fifot_adapt adapt;
+
+	port = (struct fscc_port *)dev_get_drvdata((struct device *)kobj);
+
+	fscc_fifot_get_adapt(port, &adapt);
+
+	return sprintf(buf, "%i\n", adapt.tx_min);
+}
+
+static ssize_t fifot_tx_max_store(struct kobject *kobj,
+								 struct kobj_attribute *attr, const char *buf,
+								 size_t count)
+{
+	struct fscc_port *port = 0;
+	struct fscc_fifot_adapt adapt;
+	char *end = 0;
+
+	port = (struct fscc_port *)dev_get_drvdata((struct device *)kobj);
+
+	FSCC_FIFOT_ADAPT_INIT(adapt);
+
+	adapt.tx_max = (int)simple_strtoul(buf, &end, 10);
+
+	if (fscc_fifot_set_adapt(port, &adapt) < 0)
+		return -EINVAL;
+
+	return count;
+}
+
+static ssize_t fifot_tx_max_show(struct kobject *kobj,
+								struct kobj_attribute *attr, char *buf)
+{
+	struct fscc_port *port = 0;
+	struct fscc_fifot_adapt adapt;
+
+	port = (struct fscc_port *)dev_get_drvdata((struct device *)kobj);
+
+	fscc_fifot_get_adapt(port, &adapt);
+
+	return sprintf(buf, "%i\n", adapt.tx_max);
+}
+
 static ssize_t input_memory_cap_store(struct kobject *kobj,
 								   struct kobj_attribute *attr, const char *buf,
 								   size_t count)
@@ -526,28 +1065,92 @@ static struct kobj_attribute append_status_attribute =
 static struct kobj_attribute append_timestamp_attribute =
 	__ATTR(append_timestamp, SYSFS_READ_WRITE_MODE, append_timestamp_show, append_timestamp_store);
 
+static struct kobj_attribute append_sequence_attribute =
+	__ATTR(append_sequence, SYSFS_READ_WRITE_MODE, append_sequence_show, append_sequence_store);
+
+static struct kobj_attribute timestamp_clock_attribute =
+	__ATTR(timestamp_clock, SYSFS_READ_WRITE_MODE, timestamp_clock_show, timestamp_clock_store);
+
+static struct kobj_attribute report_overflow_attribute =
+	__ATTR(report_overflow, SYSFS_READ_WRITE_MODE, report_overflow_show, report_overflow_store);
+
 static struct kobj_attribute input_memory_cap_attribute =
 	__ATTR(input_memory_cap, SYSFS_READ_WRITE_MODE, input_memory_cap_show, input_memory_cap_store);
 
+static struct kobj_attribute flush_timeout_attribute =
+	__ATTR(flush_timeout, SYSFS_READ_WRITE_MODE, flush_timeout_show, flush_timeout_store);
+
+static struct kobj_attribute tx_zero_copy_attribute =
+	__ATTR(tx_zero_copy, SYSFS_READ_WRITE_MODE, tx_zero_copy_show, tx_zero_copy_store);
+
+static struct kobj_attribute input_cap_policy_attribute =
+	__ATTR(input_cap_policy, SYSFS_READ_WRITE_MODE, input_cap_policy_show, input_cap_policy_store);
+
 static struct kobj_attribute output_memory_cap_attribute =
 	__ATTR(output_memory_cap, SYSFS_READ_WRITE_MODE, output_memory_cap_show, output_memory_cap_store);
 
+static struct kobj_attribute rx_wake_frames_attribute =
+	__ATTR(rx_wake_frames, SYSFS_READ_WRITE_MODE, rx_wake_frames_show, rx_wake_frames_store);
+
+static struct kobj_attribute rx_wake_bytes_attribute =
+	__ATTR(rx_wake_bytes, SYSFS_READ_WRITE_MODE, rx_wake_bytes_show, rx_wake_bytes_store);
+
+static struct kobj_attribute rx_wake_timeout_attribute =
+	__ATTR(rx_wake_timeout, SYSFS_READ_WRITE_MODE, rx_wake_timeout_show, rx_wake_timeout_store);
+
+static struct kobj_attribute tx_wake_bytes_attribute =
+	__ATTR(tx_wake_bytes, SYSFS_READ_WRITE_MODE, tx_wake_bytes_show, tx_wake_bytes_store);
+
+static struct kobj_attribute fifot_adapt_attribute =
+	__ATTR(fifot_adapt, SYSFS_READ_WRITE_MODE, fifot_adapt_show, fifot_adapt_store);
+
+static struct kobj_attribute fifot_rx_min_attribute =
+	__ATTR(fifot_rx_min, SYSFS_READ_WRITE_MODE, fifot_rx_min_show, fifot_rx_min_store);
+
+static struct kobj_attribute fifot_rx_max_attribute =
+	__ATTR(fifot_rx_max, SYSFS_READ_WRITE_MODE, fifot_rx_max_show, fifot_rx_max_store);
+
+static struct kobj_attribute fifot_tx_min_attribute =
+	__ATTR(fifot_tx_min, SYSFS_READ_WRITE_MODE, fifot_tx_min_show, fifot_tx_min_store);
+
+static struct kobj_attribute fifot_tx_max_attribute =
+	__ATTR(fifot_tx_max, SYSFS_READ_WRITE_MODE, fifot_tx_max_show, fifot_tx_max_store);
+
 static struct kobj_attribute ignore_timeout_attribute =
 	__ATTR(ignore_timeout, SYSFS_READ_WRITE_MODE, ignore_timeout_show, ignore_timeout_store);
 
 static struct kobj_attribute rx_multiple_attribute =
 	__ATTR(rx_multiple, SYSFS_READ_WRITE_MODE, rx_multiple_show, rx_multiple_store);
 
+static struct kobj_attribute tx_reports_attribute =
+	__ATTR(tx_reports, SYSFS_READ_WRITE_MODE, tx_reports_show, tx_reports_store);
+
 static struct kobj_attribute tx_modifiers_attribute =
 	__ATTR(tx_modifiers, SYSFS_READ_WRITE_MODE, tx_modifiers_show, tx_modifiers_store);
 
 static struct attribute *settings_attrs[] = {
 	&append_status_attribute.attr,
 	&append_timestamp_attribute.attr,
+	&append_sequence_attribute.attr,
+	&timestamp_clock_attribute.attr,
+	&report_overflow_attribute.attr,
 	&input_memory_cap_attribute.attr,
+	&input_cap_policy_attribute.attr,
 	&output_memory_cap_attribute.attr,
+	&rx_wake_frames_attribute.attr,
+	&rx_wake_bytes_attribute.attr,
+	&rx_wake_timeout_attribute.attr,
+	&tx_wake_bytes_attribute.attr,
 	&ignore_timeout_attribute.attr,
+	&flush_timeout_attribute.attr,
+	&tx_zero_copy_attribute.attr,
+	&fifot_adapt_attribute.attr,
+	&fifot_rx_min_attribute.attr,
+	&fifot_rx_max_attribute.attr,
+	&fifot_tx_min_attribute.attr,
+	&fifot_tx_max_attribute.attr,
 	&rx_multiple_attribute.attr,
+	&tx_reports_attribute.attr,
 	&tx_modifiers_attribute.attr,
 	NULL,
 };
@@ -0,0 +1,198 @@
+/*
+	Copyright (C) 2014 Commtech, Inc.
+
+	This file is part of fscc-linux.
+
+	fscc-linux is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	fscc-linux is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with fscc-linux.	If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#undef TRACE_SYSTEM
+#define TRACE_SYSTEM fscc
+
+#if !defined(FSCC_TRACE_H) || defined(TRACE_HEADER_MULTI_READ)
+#define FSCC_TRACE_H
+
+#include <linux/tracepoint.h>
+
+#include "port.h" /* struct fscc_port */
+#include "frame.h" /* struct fscc_frame, FSCC_DROP_* */
+
+#define show_drop_reason(reason) \
+	__print_symbolic(reason, \
+		{ FSCC_DROP_MEMORY_CAP, "memory_cap" }, \
+		{ FSCC_DROP_NO_MEMORY, "no_memory" }, \
+		{ FSCC_DROP_OVERFLOW, "overflow" }, \
+		{ FSCC_DROP_EVICTED, "evicted" }, \
+		{ FSCC_DROP_RECLAIMED, "reclaimed" }, \
+		{ FSCC_DROP_FILTER, "filter" }, \
+		{ FSCC_DROP_ADDRESS, "address" })
+
+TRACE_EVENT(fscc_isr,
+	TP_PROTO(struct fscc_port *port, __u32 isr_value),
+	TP_ARGS(port, isr_value),
+
+	TP_STRUCT__entry(
+		__string(port, port->name)
+		__field(__u32, isr_value)
+	),
+
+	TP_fast_assign(
+		__assign_str(port, port->name);
+		__entry->isr_value = isr_value;
+	),
+
+	TP_printk("%s isr=0x%08x", __get_str(port), __entry->isr_value)
+);
+
+TRACE_EVENT(fscc_rx_chunk,
+	TP_PROTO(struct fscc_port *port, struct fscc_frame *frame,
+			 unsigned length, unsigned finished),
+	TP_ARGS(port, frame, length, finished),
+
+	TP_STRUCT__entry(
+		__string(port, port->name)
+		__field(unsigned, number)
+		__field(unsigned, length)
+		__field(unsigned, finished)
+	),
+
+	TP_fast_assign(
+		__assign_str(port, port->name);
+		__entry->number = frame ? frame->number : 0;
+		__entry->length = length;
+		__entry->finished = finished;
+	),
+
+	TP_printk("%s F#%u <= %u bytes (%sfinished)", __get_str(port),
+			  __entry->number, __entry->length,
+			  __entry->finished ? "" : "un")
+);
+
+TRACE_EVENT(fscc_rx_frame,
+	TP_PROTO(struct fscc_port *port, struct fscc_frame *frame),
+	TP_ARGS(port, frame),
+
+	TP_STRUCT__entry(
+		__string(port, port->name)
+		__field(unsigned, number)
+		__field(unsigned, length)
+	),
+
+	TP_fast_assign(
+		__assign_str(port, port->name);
+		__entry->number = frame->number;
+		__entry->length = frame->data_length;
+	),
+
+	TP_printk("%s F#%u complete (%u bytes)", __get_str(port),
+			  __entry->number, __entry->length)
+);
+
+TRACE_EVENT(fscc_rx_drop,
+	TP_PROTO(struct fscc_port *port, struct fscc_frame *frame,
+			 unsigned length, int reason),
+	TP_ARGS(port, frame, length, reason),
+
+	TP_STRUCT__entry(
+		__string(port, port->name)
+		__field(unsigned, number)
+		__field(unsigned, length)
+		__field(int, reason)
+	),
+
+	TP_fast_assign(
+		__assign_str(port, port->name);
+		__entry->number = frame ? frame->number : 0;
+		__entry->length = length;
+		__entry->reason = reason;
+	),
+
+	TP_printk("%s F#%u dropped %u bytes (%s)", __get_str(port),
+			  __entry->number, __entry->length,
+			  show_drop_reason(__entry->reason))
+);
+
+TRACE_EVENT(fscc_tx_enqueue,
+	TP_PROTO(struct fscc_port *port, struct fscc_frame *frame),
+	TP_ARGS(port, frame),
+
+	TP_STRUCT__entry(
+		__string(port, port->name)
+		__field(unsigned, number)
+		__field(unsigned, length)
+	),
+
+	TP_fast_assign(
+		__assign_str(port, port->name);
+		__entry->number = frame->number;
+		__entry->length = frame->data_length;
+	),
+
+	TP_printk("%s F#%u queued (%u bytes)", __get_str(port),
+			  __entry->number, __entry->length)
+);
+
+TRACE_EVENT(fscc_tx_start,
+	TP_PROTO(struct fscc_port *port, struct fscc_frame *frame,
+			 unsigned length, unsigned dma, int result),
+	TP_ARGS(port, frame, length, dma, result),
+
+	TP_STRUCT__entry(
+		__string(port, port->name)
+		__field(unsigned, number)
+		__field(unsigned, length)
+		__field(unsigned, dma)
+		__field(int, result)
+	),
+
+	TP_fast_assign(
+		__assign_str(port, port->name);
+		__entry->number = frame->number;
+		__entry->length = length;
+		__entry->dma = dma;
+		__entry->result = result;
+	),
+
+	TP_printk("%s F#%u => %u bytes via %s%s", __get_str(port),
+			  __entry->number, __entry->length,
+			  __entry->dma ? "dma" : "fifo",
+			  (__entry->result != 2) ? " (starting)" : "")
+);
+
+TRACE_EVENT(fscc_tx_complete,
+	TP_PROTO(struct fscc_port *port, struct fscc_frame *frame),
+	TP_ARGS(port, frame),
+
+	TP_STRUCT__entry(
+		__string(port, port->name)
+		__field(unsigned, number)
+	),
+
+	TP_fast_assign(
+		__assign_str(port, port->name);
+		__entry->number = frame->number;
+	),
+
+	TP_printk("%s F#%u sent", __get_str(port), __entry->number)
+);
+
+#endif /* FSCC_TRACE_H */
+
+/* This part must be outside the header guard. */
+#undef TRACE_INCLUDE_PATH
+#define TRACE_INCLUDE_PATH .
+#undef TRACE_INCLUDE_FILE
+#define TRACE_INCLUDE_FILE trace
+#include <trace/define_trace.h>